@@ -0,0 +1,14 @@
+/**
+ * @file allocation.hpp
+ * @brief Definition of heap allocation counting
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+
+void SetAllocationCounting(bool enable);
+long long GetNumAllocations();
+size_t GetAllocatedBytes();
\ No newline at end of file
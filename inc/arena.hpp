@@ -0,0 +1,71 @@
+/**
+ * @file arena.hpp
+ * @brief Definition of scratch arena
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+
+/**
+ * @brief bump allocator for temporaries of a step, one per thread
+ * @details memory is released all at once by Reset(), and after a step which overflowed
+ *          the block grows to the peak so that following steps do not touch the heap
+ */
+class Arena {
+public:
+    Arena();
+    ~Arena();
+
+    template<typename T> T *Allocate(size_t n);
+    template<typename T> T *Allocate(size_t n, const T &value);
+    void Reset();
+
+    size_t GetCapacity() const;
+    size_t GetPeak() const;
+
+public:
+
+private:
+    void *AllocateBytes(size_t size, size_t align);
+
+private:
+    std::unique_ptr<char[]> block_;
+    size_t capacity_;
+    size_t offset_;
+    size_t peak_;
+
+    // blocks taken after current block ran out, released on reset
+    std::vector<std::unique_ptr<char[]>> overflow_;
+    size_t overflow_size_;
+};
+
+/**
+ * @brief allocate uninitialized array valid until reset
+ * @param[in] n number of elements
+ * @return array
+ */
+template<typename T>
+T *Arena::Allocate(size_t n) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena never runs destructors");
+    return static_cast<T*>(AllocateBytes(n * sizeof(T), alignof(T)));
+}
+
+/**
+ * @brief allocate array filled with value valid until reset
+ * @param[in] n number of elements
+ * @param[in] value initial value
+ * @return array
+ */
+template<typename T>
+T *Arena::Allocate(size_t n, const T &value) {
+    T *p = Allocate<T>(n);
+    std::fill(p, p + n, value);
+    return p;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+/**
+ * @file benchmark.hpp
+ * @brief Definition of benchmarks
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <thread>
+#include "simulater.hpp"
+#include "scenario.hpp"
+#include "allocation.hpp"
+#include "ensemble.hpp"
+#include "camera.hpp"
+#include "particle_renderer.hpp"
+
+int RunPrecisionBenchmark(float scale, int num_steps);
+int RunSweep(const std::string &path, int num_steps);
+int RunAllocationCheck(const Scenario &scenario, int num_warmup, int num_steps);
+int RunGauges(const std::string &path, int num_steps);
+int RunGridTuning(const std::string &path, int num_steps);
+int RunIntegratorBenchmark(const Scenario &scenario, double duration);
+int RunViscosityBenchmark(const Scenario &scenario, double duration);
+int RunEnsemble(const std::string &path, int num_steps, int num_workers);
+int RunPeriodic(const std::string &path, int num_steps);
+int RunCulling(const std::string &path, int num_steps);
+int RunCompact(const std::string &path, int num_steps);
+int RunPhaseScaling(const std::string &path, int num_steps);
\ No newline at end of file
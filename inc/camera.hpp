@@ -10,6 +10,7 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include <array>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "imgui.h"
@@ -26,9 +27,12 @@ public:
 
     glm::mat4 GenViewMatrix();
     glm::mat4 GenProjectionMatrix();
+    std::array<glm::vec4, 6> GenFrustum();
 
     void ImGui(GLFWwindow* window);
 
+    glm::vec3 GetPosition() const;
+
     void SetPosition(glm::vec3 position);
     void SetAspectRatio(float aspect_ratio);
 
@@ -0,0 +1,69 @@
+/**
+ * @file compact.hpp
+ * @brief Definition of compact particle state
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "constant.hpp"
+#include "utility.hpp"
+
+/**
+ * @brief snapshot of particle state quantized to a few bytes per particle, particles stored in order of grid cells
+ * @details positions are 16-bit offsets in their cells, velocities and smoothing lengths half precision,
+ *          nonzero fractions 8-bit with 8-bit phase, mass scales powers of two, derived quantities like color are not stored,
+ *          simulation itself keeps full precision arrays and only packs into or restores from this
+ */
+class CompactParticles {
+public:
+    using fraction = SparseFraction<float, kMaxPhasesPerParticle>;
+
+public:
+    CompactParticles();
+    ~CompactParticles();
+
+    void Reset(const glm::vec2 &origin, float cell_width, const glm::ivec2 &num_cells, int num_phases);
+    void Add(const glm::vec2 &pos, const glm::vec2 &vel, const fraction &frac, float mass_scale, float smoothing_len, int id, int attr, int calm_steps);
+    void Get(int k, glm::vec2 *pos, glm::vec2 *vel, fraction *frac, float *mass_scale, float *smoothing_len, int *id, int *attr, int *calm_steps) const;
+
+    int GetCell(const glm::vec2 &pos) const;
+    glm::vec2 RoundPosition(const glm::vec2 &pos) const;
+    static uint8_t EncodeFraction(float frac);
+
+    int GetNumParticles() const;
+    int GetNumPhases() const;
+    size_t GetMemoryUsage() const;
+
+public:
+
+private:
+
+private:
+    // grid
+    glm::vec2 origin_;
+    float cell_width_;
+    glm::ivec2 num_cells_;
+    int num_phases_;
+
+    // occupied cells, particles of cells_[c] start at starts_[c]
+    std::vector<uint32_t> cells_;
+    std::vector<uint32_t> starts_;
+
+    // particles, kMaxPhasesPerParticle fraction slots each, unused ones zero
+    std::vector<uint16_t> offset_;
+    std::vector<uint16_t> vel_;
+    std::vector<uint8_t> phase_;
+    std::vector<uint8_t> frac_;
+    std::vector<int8_t> mass_level_;
+    std::vector<uint16_t> smoothing_len_;
+    std::vector<int32_t> id_;
+    std::vector<uint8_t> attr_;
+    std::vector<uint8_t> calm_steps_;
+};
\ No newline at end of file
@@ -27,8 +27,23 @@ const float kGravityAcceleration = 9.80665;
 
 // particle
 const float kPointSize = 8.0f;
+const int kNumLodLevels = 4;
+
+// smoothing length, passes of neighbor count per step
+const int kSmoothingIterations = 3;
+
+// water surface
+const glm::vec3 kSurfaceColor = glm::vec3(0.3f, 0.5f, 0.9f);
+
+// integrator
+const char *const kIntegratorName[kNumIntegrators] = {"euler", "leapfrog", "verlet", "predictor_corrector"};
+
+// stage
+const char *const kStageName[kNumStages] = {"refine", "exchange", "mixture", "neighbor", "gauge", "wake", "interp_dens", "acc", "integrate", "viscosity", "height", "color", "smoothing", "quantize"};
 
 // phase
+const int kMaxPhasesPerParticle = 4;
+const int kMaxPhases = 256;
 const Phase kPhaseBoundary(2.0f, 998.29f, 30.0f, glm::vec3(0.95f, 0.3f, 0.3f));
 const Phase kPhaseA(2.0f, 998.29f, 30.0f, glm::vec3(0.3f, 0.3f, 0.95f));
 const Phase kPhaseB(2.0f, 998.29f, 30.0f, glm::vec3(0.3f, 0.95f, 0.3f));
\ No newline at end of file
@@ -0,0 +1,50 @@
+/**
+ * @file dashboard.hpp
+ * @brief Definition of performance dashboard
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include "imgui.h"
+#include "imgui_impl_glfw.h"
+#include "imgui_impl_opengl3.h"
+#include "constant.hpp"
+#include "type.hpp"
+
+/**
+ * @brief rolling performance statistics of simulation
+ */
+class Dashboard {
+public:
+    Dashboard(int history_size);
+    ~Dashboard();
+
+    void ImGui(GLFWwindow* window);
+
+    void Record(const Statistics &stats);
+
+public:
+
+private:
+    float GetAverage(const std::vector<float> &history) const;
+
+private:
+    // ring buffers of milliseconds
+    int history_size_;
+    int offset_;
+    int num_records_;
+    std::vector<std::vector<float>> stage_history_;
+    std::vector<float> step_history_;
+    std::vector<float> interval_history_;
+    std::chrono::steady_clock::time_point last_record_;
+
+    // latest snapshot
+    Statistics stats_;
+};
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ * @file decomposition.hpp
+ * @brief Definition of domain decomposition
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "transport.hpp"
+#include "scenario.hpp"
+
+/**
+ * @brief split grid into slabs of cell columns, one per process
+ */
+class Decomposition {
+public:
+    Decomposition(const glm::vec2 &origin, float cell_width, int num_cells, float halo_width, std::unique_ptr<Transport> transport);
+    ~Decomposition();
+
+    int GetRank() const;
+    int GetNumSubdomains() const;
+    std::vector<int> GetNeighbors() const;
+
+    int FindOwner(const glm::vec2 &pos) const;
+    int FindDestination(const glm::vec2 &pos) const;
+    bool IsInside(const glm::vec2 &pos, float margin) const;
+    bool IsInHalo(const glm::vec2 &pos, int rank) const;
+
+    void Exchange(const std::vector<std::vector<char>> &send, std::vector<std::vector<char>> *recv);
+
+public:
+
+private:
+
+private:
+    std::unique_ptr<Transport> transport_;
+    std::vector<float> bounds_;
+    float halo_width_;
+};
+
+// serialization
+
+/**
+ * @brief append value to message
+ * @param[in] value value
+ * @param[out] buf message
+ */
+template<typename T>
+void Pack(const T &value, std::vector<char> *buf) {
+    size_t offset = buf->size();
+    buf->resize(offset + sizeof(T));
+    std::memcpy(buf->data() + offset, &value, sizeof(T));
+}
+
+/**
+ * @brief check that values lie within message
+ * @param[in] buf message
+ * @param[in] offset read position
+ * @param[in] count number of values
+ * @return readable or not
+ */
+template<typename T>
+bool CanUnpack(const std::vector<char> &buf, size_t offset, size_t count = 1) {
+    return offset <= buf.size() && (buf.size() - offset) / sizeof(T) >= count;
+}
+
+/**
+ * @brief read value from message
+ * @param[in] buf message
+ * @param[in,out] offset read position
+ * @return value
+ */
+template<typename T>
+T Unpack(const std::vector<char> &buf, size_t *offset) {
+    T value;
+    std::memcpy(&value, buf.data() + *offset, sizeof(T));
+    *offset += sizeof(T);
+    return value;
+}
+
+// launcher
+
+template<typename Real, typename Accum> class Simulater;
+using SnapshotFn = void (*)(const Simulater<float, float> &simulater, int step, std::vector<char> *buf);
+
+int RunDecomposed(const Scenario &scenario, int num_subdomains, int num_steps, bool verbose, double *seconds, int *num_fluid, SnapshotFn snapshot = nullptr, int interval = 1, std::vector<std::vector<char>> *snapshots = nullptr, int max_threads = 0);
\ No newline at end of file
@@ -0,0 +1,52 @@
+/**
+ * @file ensemble.hpp
+ * @brief Definition of ensemble runner
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include "simulater.hpp"
+#include "scenario.hpp"
+
+/**
+ * @brief variants of a scenario run concurrently without window, one simulater per worker at a time
+ */
+class Ensemble {
+public:
+    Ensemble(const Scenario &scenario);
+    ~Ensemble();
+
+    void Run(int num_steps, int num_workers);
+    bool Write(const std::string &path) const;
+
+    int GetNumMembers() const;
+    int GetNumWorkers() const;
+    double GetSeconds() const;
+    const std::vector<MemberResult> &GetResults() const;
+
+public:
+
+private:
+    void Sample(const Scenario &scenario);
+    void RunMember(int m, int num_steps, int worker, const SharedData<float> &shared);
+    double EstimateCost(const Scenario &member) const;
+
+private:
+    std::vector<Scenario> members_;
+    std::vector<MemberResult> results_;
+    int num_workers_;
+    double seconds_;
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+/**
+ * @file gauge.hpp
+ * @brief Definition of virtual wave gauges
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "type.hpp"
+#include "decomposition.hpp"
+
+/**
+ * @brief fixed probe points whose samples are logged as binary or CSV time series
+ * @details log is opened and its header written on first write, so gauges may be replaced before that
+ */
+class Gauges {
+public:
+    Gauges(const std::vector<glm::vec2> &points, const std::string &path);
+    ~Gauges();
+
+    bool IsOpen() const;
+    int GetNumGauges() const;
+    const std::vector<glm::vec2> &GetPoints() const;
+    const std::string &GetPath() const;
+
+    void SetSample(int gauge, const GaugeSample &sample);
+    void Write(double time);
+
+public:
+
+private:
+    void Open();
+    void WriteHeader();
+
+private:
+    std::vector<glm::vec2> points_;
+    std::vector<GaugeSample> samples_;
+
+    // log, CSV if path ends with .csv
+    std::string path_;
+    std::ofstream file_;
+    bool opened_;
+    bool csv_;
+    std::vector<char> buf_;
+};
\ No newline at end of file
@@ -9,21 +9,22 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#include <cmath>
 
 // Poly6
 
-float Poly6(float r, float h);
-glm::vec2 GradPoly6(const glm::vec2 &r_ij, float r, float h);
-float LaplacePoly6(float r, float h);
+template<typename T> T Poly6(T r, T h);
+template<typename T> glm::vec<2, T> GradPoly6(const glm::vec<2, T> &r_ij, T r, T h);
+template<typename T> T LaplacePoly6(T r, T h);
 
 // Spiky
 
-float Spiky(float r, float h);
-glm::vec2 GradSpiky(const glm::vec2 &r_ij, float r, float h);
-float LaplaceSpiky(float r, float h);
+template<typename T> T Spiky(T r, T h);
+template<typename T> glm::vec<2, T> GradSpiky(const glm::vec<2, T> &r_ij, T r, T h);
+template<typename T> T LaplaceSpiky(T r, T h);
 
 // Viscosity
 
-float Viscosity(float r, float h);
-glm::vec2 GradViscosity(const glm::vec2 &r_ij, float r, float h);
-float LaplaceViscosity(float r, float h);
\ No newline at end of file
+template<typename T> T Viscosity(T r, T h);
+template<typename T> glm::vec<2, T> GradViscosity(const glm::vec<2, T> &r_ij, T r, T h);
+template<typename T> T LaplaceViscosity(T r, T h);
\ No newline at end of file
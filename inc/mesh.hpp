@@ -21,10 +21,12 @@ public:
     ~Mesh();
 
     void SendDataToBuffer();
+    void SendDataToBuffer(int first, int count);
     void Draw();
 
 public:
     std::vector<glm::vec3> vertices_;
+    std::vector<glm::vec3> normals_;
     std::vector<unsigned int> indices_;
 
 private:
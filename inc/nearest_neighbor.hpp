@@ -12,40 +12,119 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <chrono>
+#include <limits>
+#include <cassert>
+#include "type.hpp"
+#include "utility.hpp"
+#include "arena.hpp"
 
 /**
- * @brief find nearest neighbor particles
+ * @brief find nearest neighbor particles on sparse grid keyed by Morton code of cells
  */
+template<typename T>
 class NearestNeighbor {
 public:
-    NearestNeighbor(const glm::vec2 &min_cord, const glm::vec2 &max_cord, float effective_radius, int num_particles);
+    NearestNeighbor(const glm::vec<2, T> &min_cord, const glm::vec<2, T> &max_cord, T effective_radius, int num_particles);
     ~NearestNeighbor();
 
-    void Register(const std::vector<glm::vec2> &ppos);
+    void Register(const std::vector<glm::vec<2, T>> &ppos);
+    void Register(const std::vector<glm::vec<2, T>> &ppos, int begin, int end);
+    void Register(const std::vector<glm::vec<2, T>> &ppos, const std::vector<int> &indices);
 
-    void Search(const std::vector<glm::vec2> &ppos, std::vector<std::vector<int>> *neighbors, float radius);
-    void Search(const glm::vec2 &pos, const std::vector<glm::vec2> &ppos, std::vector<int> *neighbors, float radius);
+    void Search(const std::vector<glm::vec<2, T>> &ppos, std::vector<std::vector<int>> *neighbors, T radius);
+    void Search(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &ppos, std::vector<int> *neighbors, T radius);
+    int CountCandidates(const glm::vec<2, T> &pos, T radius, int *num_cells) const;
+    int Count(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &ppos, T radius) const;
+
+    void SetCellWidth(T cell_width);
+    void SetPeriodic(const glm::bvec2 &periodic, const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord, T radius);
+    glm::vec<2, T> MinimumImage(const glm::vec<2, T> &r) const;
+    T Tune(const std::vector<glm::vec<2, T>> &ppos, int begin, int end, T radius, const std::vector<T> &ratios, std::vector<GridTrial> *trials);
+
+    glm::vec<2, T> GetOrigin() const;
+    glm::vec<2, T> GetCellWidth() const;
+    glm::ivec2 GetNumCells() const;
+    int GetNumOccupiedCells() const;
+    int GetNumMoved() const;
+    uint64_t GetCellHash(const glm::vec<2, T> &pos) const;
+    size_t GetMemoryUsage() const;
 
     void CheckParameters() const;
 
 public:
 
 private:
-    void SearchNeighborsInCell(const glm::vec2 &pos, const std::vector<glm::vec2> &ppos, const glm::ivec2 index, std::vector<int> *neighbors, float radius);
+    void SearchNeighborsInCell(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &ppos, const glm::ivec2 index, std::vector<int> *neighbors, T radius);
+
+    void Sort(std::pair<uint64_t, int> *hash_and_value, int n);
+    bool Update(const std::vector<glm::vec<2, T>> &ppos);
+    void BuildCells();
+    const GridCell *FindCell(uint64_t hash) const;
 
-    glm::ivec2 CalculateIndex(const glm::vec2 &pos) const;
-    int CalculateHash(const glm::vec2 &pos) const;
-    int CalculateHash(const glm::ivec2 &index) const;
+    glm::ivec2 CalculateIndex(const glm::vec<2, T> &pos) const;
+    glm::ivec2 WrapIndex(const glm::ivec2 &index, glm::vec<2, T> *shift) const;
+    uint64_t CalculateHash(const glm::vec<2, T> &pos) const;
+    uint64_t CalculateHash(const glm::ivec2 &index) const;
 
 private:
-    glm::vec2 origin_;
+    glm::vec<2, T> origin_;
+    glm::vec<2, T> world_size_;
 
-    glm::vec2 cell_width_;
+    glm::vec<2, T> cell_width_;
     glm::ivec2 num_cells_;
-    int num_all_cells_;
 
+    // axes wrapped around, cells tile the period exactly
+    glm::bvec2 periodic_;
+
+    // particles sorted by cell
     std::vector<int> sorted_index_;
-    std::vector<int> grid_hash_;
-    std::vector<int> starts_;
-    std::vector<int> ends_;
+    std::vector<uint64_t> grid_hash_;
+
+    // incremental update
+    int begin_;
+    float max_churn_;
+    int num_moved_;
+
+    // occupied cells only, open addressing by hash
+    std::vector<GridCell> cells_;
+    int num_occupied_cells_;
+
+    // temporaries of registration
+    Arena scratch_;
+};
+
+/**
+ * @brief find neighbors of particles with different radii on grids of increasing cell width
+ */
+template<typename T>
+class MultiLevelNeighbor {
+public:
+    MultiLevelNeighbor(const glm::vec<2, T> &min_cord, const glm::vec<2, T> &max_cord, T min_radius, int num_levels, int num_particles);
+    ~MultiLevelNeighbor();
+
+    void Register(const std::vector<glm::vec<2, T>> &ppos, const std::vector<T> &radii, int begin, int end);
+    void Search(const glm::vec<2, T> &pos, T radius, const std::vector<glm::vec<2, T>> &ppos, std::vector<int> *neighbors);
+    int Count(const glm::vec<2, T> &pos, T radius, const std::vector<glm::vec<2, T>> &ppos) const;
+
+    void SetPeriodic(const glm::bvec2 &periodic, const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord);
+
+    int GetLevel(T radius) const;
+    int GetNumLevels() const;
+    const NearestNeighbor<T> &GetGrid(int level) const;
+    size_t GetMemoryUsage() const;
+
+public:
+
+private:
+
+private:
+    T min_radius_;
+    std::vector<std::unique_ptr<NearestNeighbor<T>>> levels_;
+    std::vector<std::vector<int>> indices_;
+    std::vector<T> max_radii_;
+    const std::vector<T> *radii_;
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * @file particle_renderer.hpp
+ * @brief Definition of particle renderer
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include "constant.hpp"
+
+/**
+ * @brief particles binned into grid cells, cells outside frustum culled and distant ones decimated
+ */
+class ParticleRenderer {
+public:
+    ParticleRenderer(const glm::vec2 &min_coord, const glm::vec2 &max_coord, int num_cells);
+    ~ParticleRenderer();
+
+    void Update(const std::vector<glm::vec2> &pos, const std::vector<float> &height, const std::vector<glm::vec3> &col);
+    int Cull(const std::array<glm::vec4, 6> &frustum, const glm::vec3 &eye);
+    void Draw(const std::array<glm::vec4, 6> &frustum, const glm::vec3 &eye);
+
+    void SetCulling(bool culling);
+    void SetLodDistance(float distance);
+
+    bool GetCulling() const;
+    float GetLodDistance() const;
+    int GetNumCells() const;
+    int GetNumVisibleCells() const;
+    int GetNumParticles() const;
+    int GetNumDrawnParticles() const;
+    size_t GetMemoryUsage() const;
+
+public:
+
+private:
+    bool IsVisible(int cell, const std::array<glm::vec4, 6> &frustum) const;
+    void UpdateBuffer();
+
+private:
+    // grid over xz plane, particles of a cell are contiguous
+    glm::vec2 min_coord_;
+    glm::vec2 cell_width_;
+    glm::ivec2 num_cells_;
+    std::vector<int> cell_start_;
+    std::vector<int> cell_cursor_;
+    std::vector<glm::vec2> cell_height_;
+
+    // particles in cell order, every stride-th of a cell first so that prefixes are decimated subsets
+    std::vector<glm::vec2> pos_;
+    std::vector<float> height_;
+    std::vector<glm::vec3> col_;
+    std::vector<int> cell_;
+
+    // settings, cells farther than lod distance draw half of their particles per doubling
+    bool culling_;
+    float lod_distance_;
+
+    // ranges to draw per level of detail
+    std::vector<GLint> first_[kNumLodLevels];
+    std::vector<GLsizei> count_[kNumLodLevels];
+    int num_visible_cells_;
+    int num_drawn_;
+
+    // buffers, created on first draw
+    GLuint vao_;
+    GLuint vbo_;
+    int buffer_size_;
+    bool buffer_updated_;
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * @file recorder.hpp
+ * @brief Definition of offscreen frame recorder
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+/**
+ * @brief renders into framebuffer object, reads frames back through ring of pixel buffers
+ *        and writes them as PPM images on a background thread
+ */
+class Recorder {
+public:
+    Recorder(int width, int height, const std::string &prefix, int num_pixel_buffers = 3, int num_frames_in_flight = 4);
+    ~Recorder();
+
+    void Begin();
+    void End();
+    void Finish();
+
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetNumFrames() const;
+    int GetNumFailedFrames() const;
+    double GetReadbackSeconds() const;
+    double GetStallSeconds() const;
+    double GetWriteSeconds() const;
+
+public:
+
+private:
+    void Collect();
+    void Write();
+
+private:
+    // framebuffer
+    int width_;
+    int height_;
+    GLuint fbo_;
+    GLuint color_;
+    GLuint depth_;
+    GLint viewport_[4];
+
+    // pixel buffers, frame is mapped num_pixel_buffers - 1 frames after its read was issued
+    std::vector<GLuint> pbo_;
+    int num_issued_;
+    int num_collected_;
+    // frames whose buffer could not be mapped, skipped in image sequence
+    int num_failed_;
+
+    // frames handed to writer, recycled once written
+    std::vector<std::vector<unsigned char>> frames_;
+    std::vector<int> free_;
+    std::deque<std::pair<int, int>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool done_;
+    std::thread writer_;
+
+    // image sequence, prefix followed by frame number
+    std::string prefix_;
+    std::vector<unsigned char> row_;
+
+    // seconds spent mapping buffers, waiting for writer and writing
+    double readback_seconds_;
+    double stall_seconds_;
+    double write_seconds_;
+};
\ No newline at end of file
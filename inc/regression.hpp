@@ -0,0 +1,19 @@
+/**
+ * @file regression.hpp
+ * @brief Definition of golden trajectory regression
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include "simulater.hpp"
+
+int RecordTrajectory(float scale, int num_steps, int interval, bool deterministic, const std::string &path);
+int CompareTrajectory(const std::string &path, const Tolerance &tolerance, const TrajectoryVariant &variant);
+int CheckDecomposed(const Scenario &scenario, int num_subdomains, int num_steps, int interval, const Tolerance &tolerance);
\ No newline at end of file
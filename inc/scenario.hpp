@@ -0,0 +1,104 @@
+/**
+ * @file scenario.hpp
+ * @brief Definition of scenario
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "constant.hpp"
+#include "utility.hpp"
+
+/**
+ * @brief rectangle filled with fluid at start, given relative to domain
+ */
+struct FluidRegion {
+    glm::vec2 min_coord;
+    glm::vec2 max_coord;
+    glm::vec2 vel;
+    std::vector<float> frac;
+
+    FluidRegion(const glm::vec2 &min_coord, const glm::vec2 &max_coord, const glm::vec2 &vel, const std::vector<float> &frac)
+    : min_coord(min_coord), max_coord(max_coord), vel(vel), frac(frac)
+    {}
+};
+
+/**
+ * @brief solid obstacle of wall boundary, points given relative to domain and radius relative to its width
+ * @details circle has its center, box its minimum and maximum coordinate and polygon its vertices as points
+ */
+struct Obstacle {
+    ObstacleShape shape;
+    std::vector<glm::vec2> points;
+    float radius;
+
+    Obstacle(ObstacleShape shape, const std::vector<glm::vec2> &points, float radius = 0.0f)
+    : shape(shape), points(points), radius(radius)
+    {}
+};
+
+/**
+ * @brief domain, parameters, phases and initial fluid of a simulation
+ */
+struct Scenario {
+    // domain
+    float scale;
+    ground terrain;
+    glm::bvec2 periodic;
+    BoundaryModel boundary_model;
+    std::vector<Obstacle> obstacles;
+
+    // simulation
+    float dt;
+    Integrator integrator;
+    int kernel_particles;
+    std::string kernel;
+    int num_boundary_layers;
+    bool adaptive;
+    bool variable_smoothing;
+    bool implicit_viscosity;
+    bool compact_state;
+    bool deterministic;
+    bool sleeping;
+
+    // grid cell width over effective radius, 0 for power of two division of domain
+    bool tune_grid;
+    float cell_ratio;
+
+    // phases, the first one is boundary
+    std::vector<Phase> phases;
+    std::vector<FluidRegion> regions;
+
+    // virtual wave gauges given relative to domain, logged every interval steps
+    std::vector<glm::vec2> gauges;
+    std::string gauge_path;
+    int gauge_interval;
+
+    // parameter sweep
+    std::vector<float> sweep_scales;
+    std::vector<int> sweep_subdomains;
+    std::vector<std::string> sweep_kernels;
+    std::vector<int> sweep_threads;
+    bool weak_scaling;
+
+    // ensemble of variants, initial velocity of fluid and viscosity scale of fluid phases drawn from ranges
+    int num_members;
+    unsigned int ensemble_seed;
+    bool vary_inflow;
+    glm::vec2 min_inflow;
+    glm::vec2 max_inflow;
+    glm::vec2 visc_scale;
+    std::string ensemble_path;
+
+    Scenario(float scale = 4.0f);
+};
+
+bool LoadScenario(const std::string &path, Scenario *scenario);
\ No newline at end of file
@@ -15,13 +15,14 @@
 #include "camera.hpp"
 #include "shader.hpp"
 #include "simulater.hpp"
+#include "dashboard.hpp"
 
 /**
  * @brief configuration of scene
  */
 class Scene {
 public:
-    Scene(int window_width, int window_height);
+    Scene(int window_width, int window_height, const Scenario &scenario);
     ~Scene();
 
     void ImGui(GLFWwindow* window);
@@ -37,11 +38,16 @@ public:
 private:
     void DrawParticles(const glm::mat4 &view, const glm::mat4 &projection);
     void DrawTerrain(const glm::mat4 &view, const glm::mat4 &projection);
+    void DrawSurface(const glm::mat4 &view, const glm::mat4 &projection);
 
 private:
     std::unique_ptr<DirectionalLight> light_;
     std::unique_ptr<Camera> camera_;
     std::unique_ptr<Shader> shader_;
     std::unique_ptr<Shader> terrain_shader_;
-    std::unique_ptr<Simulater> simulater_;
+    std::unique_ptr<Shader> surface_shader_;
+    bool draw_surface_;
+    std::unique_ptr<Simulater<float>> simulater_;
+    std::unique_ptr<Dashboard> dashboard_;
+    Statistics stats_;
 };
\ No newline at end of file
@@ -13,86 +13,263 @@
 #include <vector>
 #include <memory>
 #include <numeric>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <thread>
 #include "constant.hpp"
 #include "nearest_neighbor.hpp"
 #include "terrain.hpp"
+#include "surface.hpp"
+#include "particle_renderer.hpp"
+#include "gauge.hpp"
+#include "wall.hpp"
 #include "kernel.hpp"
 #include "utility.hpp"
+#include "decomposition.hpp"
+#include "scenario.hpp"
+#include "arena.hpp"
+#include "compact.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief read-only data of a domain, shared by simulaters of an ensemble
+ */
+template<typename Real>
+struct SharedData {
+    std::shared_ptr<const Wall<Real>> wall;
+    std::shared_ptr<const Terrain> terrain;
+};
 
 /**
  * @brief shallow water simulation
+ * @tparam Real scalar type of particle data
+ * @tparam Accum scalar type of density and acceleration sums
  */
+template<typename Real, typename Accum = Real>
 class Simulater {
+public:
+    using real2 = glm::vec<2, Real>;
+    using accum2 = glm::vec<2, Accum>;
+    using fraction = SparseFraction<Real, kMaxPhasesPerParticle>;
+
 public:
     Simulater(float scale);
+    Simulater(const Scenario &scenario, const SharedData<Real> &shared = SharedData<Real>());
     ~Simulater();
 
-    float GetDeltaTime();
+    Real GetDeltaTime();
+    double GetTime() const;
+    double GetEnergy() const;
+    int GetNumParticles(ParticleAttribute attr) const;
+    const std::vector<real2> &GetPositions() const;
+    const std::vector<Real> &GetInterpDensities() const;
+    const std::vector<Real> &GetHeights() const;
+    const std::vector<ParticleAttribute> &GetAttributes() const;
+    const std::vector<int> &GetIds() const;
+    void GetStatistics(Statistics *stats) const;
+    const std::vector<GridTrial> &GetGridTrials() const;
+    Real GetCellWidth() const;
+    Real GetEffectiveRadius() const;
+    int GetViscosityIterations() const;
+    SharedData<Real> GetSharedData() const;
+    ParticleRenderer *GetParticleRenderer();
+
+    void SetDeterministic(bool deterministic);
+    void SetMaxThreads(int max_threads);
+
+    void SetDecomposition(std::unique_ptr<Transport> transport);
+
+    void Compact(CompactParticles *state) const;
+    void Expand(const CompactParticles &state);
 
     void Evolve();
-    void DrawParticles();
+    void UpdateSurface();
+    void DrawParticles(const std::array<glm::vec4, 6> &frustum, const glm::vec3 &eye);
     void DrawTerrain();
+    void DrawSurface();
 
 public:
 
 private:
-    void AddParticle(const glm::vec2 &pos, const glm::vec2 &vel, const glm::vec2 &acc, const glm::vec3 &col, float mass, float visc, float dens, float interp_dens, const std::vector<float> &frac, float height, ParticleAttribute attr);
+    void AddParticle(const real2 &pos, const real2 &vel, const real2 &acc, const glm::vec3 &col, Real mass, Real visc, Real dens, Real interp_dens, const fraction &frac, Real height, ParticleAttribute attr);
     void GenerateBoundary();
-    void GenerateFluid(const glm::vec2 &min_pos, const glm::vec2 &max_pos);
+    void GenerateFluid(const real2 &min_pos, const real2 &max_pos, const real2 &vel, const std::vector<Real> &frac);
+    void RemoveParticles(const bool *removed);
+
+    void Exchange();
+    void PackParticle(int i, std::vector<char> *buf) const;
+    bool UnpackParticle(const std::vector<char> &buf, size_t *offset, ParticleAttribute attr);
+
+    void BuildBoundaryGrid();
+    void SearchNeighbors();
+    void WakeParticles();
+    bool IsAsleep(int i) const;
+
+    void Refine();
+    bool SplitParticle(int i);
+    void MergeParticles(int i, int j);
 
     void CalcCol();
     void CalcMixture();
+    void ClearDirtyFractions();
+    void Compress(const Real *frac, const int *phase, int count, fraction *sparse) const;
+    Real CalcFractionJump(const fraction &a, const fraction &b) const;
     void CalcInterpDens();
     void CalcAcc();
     void CalcHeight();
+    void UpdateSmoothingLength(Real *smoothing_len);
+    void Drift();
+    void PredictVelocity();
     void Integrate();
+    bool UpdateActivity(int i);
+    void LimitVelocity(int i);
+    void Collide(int i);
+    void SolveViscosity();
+    void Quantize();
 
     void UpdateBuffer();
 
+    void SetGauges(const std::vector<glm::vec2> &points, const std::string &path);
+    void SampleGauges();
+
+    void Lap(Stage stage, std::chrono::steady_clock::time_point *tic);
+    ThreadPool *GetPool();
+
 private:
     // scale
-    glm::vec2 min_coord_;
-    glm::vec2 max_coord_;
+    real2 min_coord_;
+    real2 max_coord_;
+
+    // axes leaving domain on one side and entering on the other
+    glm::bvec2 periodic_;
+    real2 period_;
 
     // simulation
-    float dt_;
+    Real dt_;
+
+    // time integration, state at start of step for two stage integrators
+    Integrator integrator_;
+    Real verlet_lambda_;
+    std::vector<real2> pos_start_;
+    std::vector<real2> vel_start_;
+    std::vector<real2> acc_start_;
 
     // kernel
     int kernel_particles_;
-    kernel kernel_;
-    gkernel gkernel_;
-    lkernel lkernel_;
+    kernel<Real> kernel_;
+    gkernel<Real> gkernel_;
+    lkernel<Real> lkernel_;
 
     // particles
-    float effective_rad_;
-    float particle_rad_;
+    Real effective_rad_;
+    Real particle_rad_;
     std::vector<Phase> phase_;
-    std::vector<glm::vec2> pos_;
-    std::vector<glm::vec2> vel_;
-    std::vector<glm::vec2> acc_;
+    std::vector<real2> pos_;
+    std::vector<real2> vel_;
+    std::vector<real2> acc_;
     std::vector<glm::vec3> col_;
-    std::vector<float> mass_;
-    std::vector<float> visc_;
-    std::vector<float> dens_;
-    std::vector<float> interp_dens_;
-    std::vector<std::vector<float>> frac_;
-    std::vector<float> height_;
+    std::vector<Real> mass_;
+    std::vector<Real> visc_;
+    std::vector<Real> dens_;
+    std::vector<Real> interp_dens_;
+    std::vector<fraction> frac_;
+    std::vector<bool> frac_dirty_;
+    std::vector<Real> height_;
     std::vector<ParticleAttribute> attr_;
+    std::vector<int> calm_steps_;
+    std::vector<int> id_;
+    std::vector<Real> mass_scale_;
+    std::vector<Real> smoothing_len_;
     std::vector<int> num_particles_;
+    int next_id_;
+
+    // reduction
+    bool deterministic_;
+
+    // state rounded to what a compact snapshot holds after every step, arrays stay full precision
+    bool compact_state_;
+    // cell layout of snapshots, holds no particles
+    CompactParticles quantizer_;
+
+    // smoothing length
+    bool variable_smoothing_;
+    int target_neighbors_;
+    Real min_smoothing_len_;
+    Real max_smoothing_len_;
+
+    // viscosity, implicit solve replaces explicit term of acceleration
+    bool implicit_viscosity_;
+    Real viscosity_tol_;
+    int max_viscosity_iterations_;
+    int viscosity_iterations_;
+
+    // refinement
+    bool adaptive_;
+    Real split_depth_;
+    Real split_frac_;
+    Real merge_depth_;
+    Real merge_vel_;
+    Real min_mass_scale_;
+
+    // activity
+    Real sleep_vel_;
+    Real sleep_acc_;
+    int sleep_steps_;
 
     // boundary
+    BoundaryModel boundary_model_;
     int num_boundary_layers_;
-    glm::vec2 min_boundary_coord_;
-    glm::vec2 max_boundary_coord_;
+    real2 min_boundary_coord_;
+    real2 max_boundary_coord_;
+    std::vector<Real> boundary_dens_;
+    std::shared_ptr<const Wall<Real>> wall_;
+    std::vector<Real> wall_dist_;
+    std::vector<real2> wall_grad_;
+    std::vector<Real> wall_lap_;
 
     // buffers
-    GLuint vao_;
-    GLuint vbo_;
+    bool buffer_updated_;
+    std::vector<glm::vec2> buffer_pos_;
+    std::vector<float> buffer_height_;
+    std::unique_ptr<ParticleRenderer> renderer_;
 
     // nearest neighbor
     std::vector<std::vector<int>> neighbor_;
-    std::unique_ptr<NearestNeighbor> nn_;
+    int neighbor_capacity_;
+    std::unique_ptr<NearestNeighbor<Real>> nn_;
+    std::unique_ptr<NearestNeighbor<Real>> boundary_nn_;
+    std::unique_ptr<MultiLevelNeighbor<Real>> mnn_;
+    std::vector<GridTrial> grid_trials_;
 
     // terrain
-    std::unique_ptr<Terrain> terrain_;
+    std::shared_ptr<const Terrain> terrain_;
+
+    // water surface, built on first update so headless members skip it, fluid particles copied to single precision
+    std::unique_ptr<Surface> surface_;
+    bool surface_updated_;
+    std::vector<glm::vec2> surface_pos_;
+    std::vector<int> surface_ids_;
+    std::vector<float> surface_vol_;
+    std::vector<float> surface_height_;
+
+    // virtual wave gauges, sorted by cell for locality
+    std::unique_ptr<Gauges> gauges_;
+    std::vector<int> gauge_order_;
+    std::vector<std::vector<int>> gauge_neighbors_;
+    int gauge_interval_;
+    int num_steps_;
+
+    // temporaries of a step
+    Arena arena_;
+
+    // threads of parallel stages, pool started on first use
+    int max_threads_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    // profiling, seconds of stages in last step
+    double stage_time_[kNumStages];
+
+    // domain decomposition
+    std::unique_ptr<Decomposition> decomposition_;
 };
\ No newline at end of file
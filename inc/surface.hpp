@@ -0,0 +1,76 @@
+/**
+ * @file surface.hpp
+ * @brief Definition of water surface reconstruction
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "kernel.hpp"
+#include "mesh.hpp"
+#include "nearest_neighbor.hpp"
+#include "terrain.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief water surface splatted from particle heights onto regular grid, updated per tile
+ */
+class Surface {
+public:
+    Surface(const glm::vec2 &min_coord, const glm::vec2 &max_coord, float spacing, float effective_radius, int num_particles);
+    ~Surface();
+
+    void Update(const std::vector<glm::vec2> &pos, const std::vector<int> &ids, const std::vector<float> &vol, const std::vector<float> &height, const Terrain *terrain, ThreadPool *pool);
+    void Draw();
+
+    int GetNumTiles() const;
+    int GetNumDirtyTiles() const;
+    size_t GetMemoryUsage() const;
+
+public:
+
+private:
+    void MarkTiles(const glm::vec2 &pos, std::vector<bool> *marked) const;
+    void Splat(int tile, const std::vector<glm::vec2> &pos, const std::vector<float> &vol, const std::vector<float> &height, const Terrain *terrain, std::vector<int> *neighbors);
+    void BuildTile(int tile);
+    void BuildIndices();
+
+    int GetVertex(int x, int z) const;
+
+private:
+    // grid
+    glm::vec2 min_coord_;
+    float spacing_;
+    float effective_rad_;
+    glm::ivec2 num_vertices_;
+    std::vector<float> grid_height_;
+
+    // tiles of tile_size_ x tile_size_ cells
+    int tile_size_;
+    glm::ivec2 num_tiles_;
+    std::vector<bool> dirty_;
+    std::vector<bool> stale_;
+    std::vector<int> tiles_;
+    int num_dirty_;
+
+    // particles at last update, survivors keep their order and new ones follow them
+    std::vector<glm::vec2> prev_pos_;
+    std::vector<int> prev_ids_;
+    std::unique_ptr<NearestNeighbor<float>> nn_;
+
+    // neighbor lists of tasks
+    std::vector<std::vector<int>> neighbors_;
+
+    // depth below which vertex is dry and sunk under terrain
+    float dry_depth_;
+
+    // mesh, one block of vertices per tile
+    std::unique_ptr<Mesh> mesh_;
+    std::vector<glm::vec3> vertices_;
+    std::vector<glm::vec3> normals_;
+};
\ No newline at end of file
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <memory>
 #include "type.hpp"
 #include "mesh.hpp"
 
@@ -19,16 +20,20 @@ public:
     Terrain(const ground &fn, const glm::vec2 &min_coord, const glm::vec2 &max_coord);
     ~Terrain();
 
-    void Draw();
+    void Draw() const;
 
-    float GetHeight(const glm::vec2 &r);
+    float GetHeight(const glm::vec2 &r) const;
 
 public:
 
 private:
-    void ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::vec2 &max_coord);
+    void ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::vec2 &max_coord) const;
 
 private:
     ground fn_;
-    Mesh mesh_;
+    glm::vec2 min_coord_;
+    glm::vec2 max_coord_;
+
+    // built on first draw, only from the thread owning GL context
+    mutable std::unique_ptr<Mesh> mesh_;
 };
\ No newline at end of file
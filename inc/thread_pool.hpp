@@ -0,0 +1,62 @@
+/**
+ * @file thread_pool.hpp
+ * @brief Definition of thread pool
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * @brief persistent workers that run numbered tasks of parallel stages together with the calling thread
+ * @details tasks are taken in any order, so results should be written per task and reduced in task order
+ *          by the caller; running tasks allocates nothing
+ */
+class ThreadPool {
+public:
+    ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    template<typename F> void Run(int num_tasks, const F &fn);
+
+    int GetNumThreads() const;
+
+public:
+
+private:
+    void Dispatch(int num_tasks, void (*invoke)(const void*, int), const void *fn);
+    void RunTasks();
+    void Work();
+
+private:
+    // workers, the calling thread is the last one
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable finish_;
+    bool stop_;
+
+    // current batch of tasks, a new generation wakes the workers
+    int generation_;
+    void (*invoke_)(const void*, int);
+    const void *fn_;
+    int num_tasks_;
+    std::atomic<int> next_task_;
+    int num_finished_;
+};
+
+/**
+ * @brief run tasks and wait for all of them
+ * @param[in] num_tasks number of tasks
+ * @param[in] fn task taking its number
+ */
+template<typename F>
+void ThreadPool::Run(int num_tasks, const F &fn) {
+    Dispatch(num_tasks, [](const void *f, int k) { (*static_cast<const F*>(f))(k); }, &fn);
+}
\ No newline at end of file
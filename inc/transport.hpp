@@ -0,0 +1,58 @@
+/**
+ * @file transport.hpp
+ * @brief Definition of transport between subdomains
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <memory>
+
+/**
+ * @brief message transport between processes running subdomains
+ */
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    virtual int GetRank() const = 0;
+    virtual int GetSize() const = 0;
+
+    virtual void Send(int dst, const std::vector<char> &data) = 0;
+    virtual void Receive(int src, std::vector<char> *data) = 0;
+};
+
+/**
+ * @brief transport over local (unix domain) sockets
+ */
+class LocalSocketTransport : public Transport {
+public:
+    LocalSocketTransport(int rank, int size);
+    ~LocalSocketTransport();
+
+    static std::vector<std::unique_ptr<LocalSocketTransport>> CreateGroup(int size);
+
+    int GetRank() const override;
+    int GetSize() const override;
+
+    void Send(int dst, const std::vector<char> &data) override;
+    void Receive(int src, std::vector<char> *data) override;
+
+public:
+
+private:
+    void WriteAll(int fd, const char *data, size_t size);
+    void ReadAll(int fd, char *data, size_t size);
+
+private:
+    int rank_;
+    int size_;
+    std::vector<int> fds_;
+};
\ No newline at end of file
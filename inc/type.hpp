@@ -8,12 +8,17 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
 
 // kernel function pointer
 
-using kernel = float (*)(float, float);
-using gkernel = glm::vec2 (*)(const glm::vec2 &, float, float);
-using lkernel = float (*)(float, float);
+template<typename T> using kernel = T (*)(T, T);
+template<typename T> using gkernel = glm::vec<2, T> (*)(const glm::vec<2, T> &, T, T);
+template<typename T> using lkernel = T (*)(T, T);
 
 // ground function pointer
 
@@ -24,9 +29,108 @@ using ground = float (*)(const glm::vec2 &);
 enum ParticleAttribute {
     kBoundary,
     kFluid,
+    kGhost,
     kNumAttributes
 };
 
+// boundary model
+
+enum BoundaryModel {
+    kBoundaryParticle,
+    kBoundaryWall
+};
+
+// shape of obstacle in wall boundary
+
+enum ObstacleShape {
+    kObstacleCircle,
+    kObstacleBox,
+    kObstaclePolygon
+};
+
+// time integration scheme
+
+enum Integrator {
+    kIntegratorEuler,
+    kIntegratorLeapfrog,
+    kIntegratorVerlet,
+    kIntegratorPredictorCorrector,
+    kNumIntegrators
+};
+
+// occupied cell of sparse grid
+
+struct GridCell {
+    uint64_t hash;
+    int start;
+    int end;
+};
+
+// stage of time evolution
+
+enum Stage {
+    kStageRefine,
+    kStageExchange,
+    kStageMixture,
+    kStageNeighbor,
+    kStageGauge,
+    kStageWake,
+    kStageInterpDens,
+    kStageAcc,
+    kStageIntegrate,
+    kStageViscosity,
+    kStageHeight,
+    kStageColor,
+    kStageSmoothing,
+    kStageQuantize,
+    kNumStages
+};
+
+// snapshot of simulation for performance monitoring
+
+struct Statistics {
+    double stage_time[kNumStages];
+    int num_particles[kNumAttributes];
+    std::vector<int> neighbor_hist;
+    int neighbor_bin;
+    int max_neighbors;
+    float avg_neighbors;
+    int num_occupied_cells;
+    int num_cells;
+    std::vector<std::pair<std::string, size_t>> memory;
+};
+
+// measured search cost of grid with a cell width
+
+struct GridTrial {
+    double cell_width;
+    double seconds;
+    double cells_per_search;
+    double candidates_per_hit;
+};
+
+// sample of virtual wave gauge
+
+struct GaugeSample {
+    float depth;
+    float height;
+    glm::vec2 vel;
+};
+
+// outcome of ensemble member
+
+struct MemberResult {
+    glm::vec2 inflow;
+    float visc_scale;
+    int num_particles;
+    int num_steps;
+    double seconds;
+    float max_height;
+    double energy;
+    bool finite;
+    int worker;
+};
+
 // phase
 
 struct Phase {
@@ -38,4 +142,44 @@ struct Phase {
     Phase(float mass, float dens, float visc, const glm::vec3 &col)
     : mass(mass), dens(dens), visc(visc), col(col)
     {}
+};
+
+// nonzero fractions of a particle in ascending order of phase
+
+template<typename T, int N>
+struct SparseFraction {
+    int count;
+    int phase[N];
+    T frac[N];
+
+    SparseFraction()
+    : count(0)
+    {}
+};
+
+// tolerance of trajectory comparison
+
+struct Tolerance {
+    double pos;
+    double interp_dens;
+    double height;
+
+    Tolerance(double pos, double interp_dens, double height)
+    : pos(pos), interp_dens(interp_dens), height(height)
+    {}
+};
+
+// configuration a reference trajectory is rerun with
+
+struct TrajectoryVariant {
+    bool deterministic;
+    bool compact_state;
+    bool tune_grid;
+    bool sleeping;
+    bool mixed_precision;
+    int num_subdomains;
+
+    TrajectoryVariant()
+    : deterministic(false), compact_state(false), tune_grid(false), sleeping(true), mixed_precision(false), num_subdomains(1)
+    {}
 };
\ No newline at end of file
@@ -9,15 +9,44 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
 #include "type.hpp"
 
 // interpolation with kernel function
 
-float Interpolate(const std::vector<float> &m, const std::vector<float> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const kernel &w, float h);
+template<typename T>
+T Interpolate(const std::vector<T> &m, const std::vector<T> &phi, const std::vector<T> &rho, const std::vector<glm::vec<2, T>> &r, int i, const std::vector<int> &indices, const kernel<T> &w, T h);
 
-glm::vec2 InterpolateGradient(const std::vector<float> &m, const std::vector<float> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const gkernel &w, float h);
+template<typename T>
+glm::vec<2, T> InterpolateGradient(const std::vector<T> &m, const std::vector<T> &phi, const std::vector<T> &rho, const std::vector<glm::vec<2, T>> &r, int i, const std::vector<int> &indices, const gkernel<T> &w, T h);
 
-glm::vec2 InterpolateLaplacian(const std::vector<float> &m, const std::vector<glm::vec2> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const lkernel &w, float h);
+template<typename T>
+glm::vec<2, T> InterpolateLaplacian(const std::vector<T> &m, const std::vector<glm::vec<2, T>> &phi, const std::vector<T> &rho, const std::vector<glm::vec<2, T>> &r, int i, const std::vector<int> &indices, const lkernel<T> &w, T h);
+
+// memory held by vector
+
+template<typename T>
+size_t GetMemoryUsage(const std::vector<T> &v) {
+    return v.capacity() * sizeof(T);
+}
+
+// displacement to nearest image along periodic axes
+
+template<typename V>
+V MinimumImage(const V &r, const glm::bvec2 &periodic, const V &period) {
+    V image = r;
+    for(int a = 0; a < 2; a++) {
+        if(periodic[a]) image[a] -= period[a] * std::round(r[a] / period[a]);
+    }
+    return image;
+}
+
+// half precision
+
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t half);
 
 // ground function
 
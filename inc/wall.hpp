@@ -0,0 +1,66 @@
+/**
+ * @file wall.hpp
+ * @brief Definition of wall boundary
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include "type.hpp"
+
+/**
+ * @brief wall boundary given by signed distance field
+ */
+template<typename T>
+class Wall {
+public:
+    Wall(const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord);
+    ~Wall();
+
+    void AddCircle(const glm::vec<2, T> &center, T radius);
+    void AddBox(const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord);
+    void AddPolygon(const std::vector<glm::vec<2, T>> &vertices);
+    void SetOpen(const glm::bvec2 &open);
+
+    void Precompute(const kernel<T> &w, const gkernel<T> &gw, const lkernel<T> &lw, T h, T min_h, T max_h, T particle_rad, int num_layers, T mass);
+
+    T Distance(const glm::vec<2, T> &pos) const;
+    glm::vec<2, T> Normal(const glm::vec<2, T> &pos) const;
+    T Sum(const glm::vec<2, T> &pos, T h, T *dens, glm::vec<2, T> *grad, T *lap) const;
+
+    T GetDensity(T d, T h) const;
+    T GetGradient(T d, T h) const;
+    T GetLaplacian(T d, T h) const;
+
+public:
+
+private:
+    T PolygonDistance(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &vertices) const;
+    T Lookup(const std::vector<T> &table, T d, T h) const;
+    T Sample(const std::vector<T> &table, int m, T d) const;
+
+private:
+    // container
+    glm::vec<2, T> min_coord_;
+    glm::vec<2, T> max_coord_;
+    glm::bvec2 open_;
+
+    // obstacles
+    std::vector<glm::vec<2, T>> circle_centers_;
+    std::vector<T> circle_radii_;
+    std::vector<std::vector<glm::vec<2, T>>> polygons_;
+
+    // contributions of a flat wall as functions of distance, one table per smoothing length in radii_
+    T effective_rad_;
+    int num_samples_;
+    std::vector<T> radii_;
+    std::vector<T> dens_table_;
+    std::vector<T> grad_table_;
+    std::vector<T> lap_table_;
+};
\ No newline at end of file
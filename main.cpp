@@ -17,6 +17,10 @@
 #include "imgui_impl_opengl3.h"
 #include "constant.hpp"
 #include "scene.hpp"
+#include "decomposition.hpp"
+#include "benchmark.hpp"
+#include "regression.hpp"
+#include "recorder.hpp"
 
 int window_width = 800;
 int window_height = 600;
@@ -93,8 +97,18 @@ void glfwFramebufferSizeCallBack(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, window_width, window_height);
 }
 
-int main(int argc, char* argv[]) {
+// context
+
+/**
+ * @brief create window and make its GL context current
+ * @param[in] width window width
+ * @param[in] height window height
+ * @param[in] visible show window, hidden ones only hold context for offscreen rendering
+ * @return window handler
+ */
+GLFWwindow *InitContext(int width, int height, bool visible) {
     // initialize GLFW
+    glfwSetErrorCallback(glfwErrorCallBack);
     if(!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         exit(1);
@@ -107,13 +121,14 @@ int main(int argc, char* argv[]) {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, kOpenGLVersionMejor);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, kOpenGLVersionMinor);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GL_TRUE : GL_FALSE);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GL_TRUE);
 #endif
 
     // create a window
-    GLFWwindow *window = glfwCreateWindow(window_width, window_height, kTitle.c_str(), NULL, NULL);
+    GLFWwindow *window = glfwCreateWindow(width, height, kTitle.c_str(), NULL, NULL);
     if(window == NULL) {
         std::cerr << "Falied to create GLFW window" << std::endl;
         exit(1);
@@ -122,13 +137,6 @@ int main(int argc, char* argv[]) {
     // make context current
     glfwMakeContextCurrent(window);
 
-    // register callback functions
-    glfwSetErrorCallback(glfwErrorCallBack);
-    glfwSetCursorPosCallback(window, glfwCursorPosCallBack);
-    glfwSetMouseButtonCallback(window, glfwMouseButtonCallBack);
-    glfwSetKeyCallback(window, glfwKeyCallBack);
-    glfwSetFramebufferSizeCallback(window, glfwFramebufferSizeCallBack);
-
     // initialize GLEW
     glewExperimental = GL_TRUE;
     if(glewInit() != GLEW_OK) {
@@ -142,9 +150,218 @@ int main(int argc, char* argv[]) {
     glEnable(GL_CULL_FACE);
     glClearColor(kBackgroundColor.r, kBackgroundColor.g, kBackgroundColor.b, 1.0f);
     glPointSize(kPointSize);
+    return window;
+}
+
+/**
+ * @brief render scenario into framebuffer object and write frames as image sequence
+ * @param[in] scenario scenario
+ * @param[in] num_frames number of frames
+ * @param[in] width width of frames
+ * @param[in] height height of frames
+ * @param[in] steps_per_frame number of steps between frames
+ * @param[in] prefix path of images without frame number
+ * @return exit status
+ */
+int RunOffscreen(const Scenario &scenario, int num_frames, int width, int height, int steps_per_frame, const std::string &prefix) {
+    GLFWwindow *window = InitContext(width, height, false);
+    scene = std::make_unique<Scene>(width, height, scenario);
+    Recorder recorder(width, height, prefix);
+
+    auto start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < num_frames; frame++) {
+        for(int step = 0; step < steps_per_frame; step++) scene->Update();
+        recorder.Begin();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        scene->Draw();
+        recorder.End();
+    }
+    recorder.Finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int num_failed = recorder.GetNumFailedFrames();
+    std::cout << num_frames - num_failed << " frames of " << width << "x" << height << " written to " << prefix << "*.ppm";
+    if(num_failed > 0) std::cout << ", " << num_failed << " failed";
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << seconds << " s, " << num_frames / seconds << " frames/s, per frame: "
+              << 1000.0 * recorder.GetReadbackSeconds() / num_frames << " ms readback, "
+              << 1000.0 * recorder.GetStallSeconds() / num_frames << " ms waiting for writer, "
+              << 1000.0 * recorder.GetWriteSeconds() / num_frames << " ms writing on background thread" << std::endl;
+    scene.reset();
+    glfwDestroyWindow(window);
+    return num_failed > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    // run scenario decomposed into processes without window
+    if(argc > 2 && std::string(argv[1]) == "--decompose") {
+        Scenario scenario;
+        if(!LoadScenario(argv[2], &scenario)) return 1;
+        int num_subdomains = (argc > 3) ? std::atoi(argv[3]) : 2;
+        int num_steps = (argc > 4) ? std::atoi(argv[4]) : 1000;
+        double seconds;
+        int num_fluid;
+        return RunDecomposed(scenario, num_subdomains, num_steps, true, &seconds, &num_fluid);
+    }
+
+    // compare decomposed run of scenario with one process without window
+    if(argc > 2 && std::string(argv[1]) == "--check-decomposed") {
+        Scenario scenario;
+        if(!LoadScenario(argv[2], &scenario)) return 1;
+        int num_subdomains = (argc > 3) ? std::atoi(argv[3]) : 2;
+        int num_steps = (argc > 4) ? std::atoi(argv[4]) : 200;
+        return CheckDecomposed(scenario, num_subdomains, num_steps, 10, Tolerance(0.0, 0.0, 0.0));
+    }
+
+    // sweep parameters of scenario without window
+    if(argc > 2 && std::string(argv[1]) == "--sweep") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 200;
+        return RunSweep(argv[2], num_steps);
+    }
+
+    // log gauges of scenario without window
+    if(argc > 2 && std::string(argv[1]) == "--gauges") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 1000;
+        return RunGauges(argv[2], num_steps);
+    }
+
+    // run ensemble of scenario variants without window
+    if(argc > 2 && std::string(argv[1]) == "--ensemble") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 500;
+        int num_workers = (argc > 4) ? std::atoi(argv[4]) : 0;
+        return RunEnsemble(argv[2], num_steps, num_workers);
+    }
+
+    // run periodic scenario without window
+    if(argc > 2 && std::string(argv[1]) == "--periodic") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 500;
+        return RunPeriodic(argv[2], num_steps);
+    }
+
+    // render scenario to image sequence without visible window
+    if(argc > 2 && std::string(argv[1]) == "--offscreen") {
+        Scenario scenario;
+        if(!LoadScenario(argv[2], &scenario)) return 1;
+        int num_frames = (argc > 3) ? std::atoi(argv[3]) : 300;
+        int width = (argc > 4) ? std::atoi(argv[4]) : 1280;
+        int height = (argc > 5) ? std::atoi(argv[5]) : 720;
+        int steps_per_frame = (argc > 6) ? std::atoi(argv[6]) : 5;
+        std::string prefix = (argc > 7) ? argv[7] : "frame_";
+        return RunOffscreen(scenario, num_frames, width, height, steps_per_frame, prefix);
+    }
+
+    // cull particles of scenario for camera poses without window
+    if(argc > 2 && std::string(argv[1]) == "--culling") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 100;
+        return RunCulling(argv[2], num_steps);
+    }
+
+    // compare compact snapshots with full precision without window
+    if(argc > 2 && std::string(argv[1]) == "--compact") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 500;
+        return RunCompact(argv[2], num_steps);
+    }
+
+    // add tracer phases to scenario and time steps without window
+    if(argc > 2 && std::string(argv[1]) == "--phases") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 200;
+        return RunPhaseScaling(argv[2], num_steps);
+    }
+
+    // tune grid of scenario without window
+    if(argc > 2 && std::string(argv[1]) == "--grid") {
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 200;
+        return RunGridTuning(argv[2], num_steps);
+    }
+
+    // compare float, double and mixed precision without window
+    if(argc > 1 && std::string(argv[1]) == "--precision") {
+        int num_steps = (argc > 2) ? std::atoi(argv[2]) : 1000;
+        return RunPrecisionBenchmark(4.0f, num_steps);
+    }
+
+    // count heap allocations of steady state steps without window
+    if(argc > 1 && std::string(argv[1]) == "--allocations") {
+        int num_warmup = (argc > 2) ? std::atoi(argv[2]) : 100;
+        int num_steps = (argc > 3) ? std::atoi(argv[3]) : 100;
+        Scenario scenario;
+        if(argc > 4 && !LoadScenario(argv[4], &scenario)) return 1;
+        return RunAllocationCheck(scenario, num_warmup, num_steps);
+    }
+
+    // compare integrators over time steps without window
+    if(argc > 1 && std::string(argv[1]) == "--integrators") {
+        double duration = (argc > 2) ? std::atof(argv[2]) : 1.0;
+        Scenario scenario;
+        if(argc > 3 && !LoadScenario(argv[3], &scenario)) return 1;
+        return RunIntegratorBenchmark(scenario, duration);
+    }
+
+    // compare explicit and implicit viscosity over time steps without window
+    if(argc > 1 && std::string(argv[1]) == "--viscosity") {
+        double duration = (argc > 2) ? std::atof(argv[2]) : 1.0;
+        Scenario scenario;
+        if(argc > 3 && !LoadScenario(argv[3], &scenario)) return 1;
+        return RunViscosityBenchmark(scenario, duration);
+    }
+
+    // record and compare golden trajectories without window
+    if(argc > 2 && std::string(argv[1]) == "--record") {
+        bool deterministic = std::string(argv[argc-1]) == "--deterministic";
+        int num_args = deterministic ? argc-1 : argc;
+        int num_steps = (num_args > 3) ? std::atoi(argv[3]) : 1000;
+        int interval = (num_args > 4) ? std::atoi(argv[4]) : 10;
+        return RecordTrajectory(4.0f, num_steps, interval, deterministic, argv[2]);
+    }
+    if(argc > 2 && std::string(argv[1]) == "--compare") {
+        // tolerances followed by options of rerun
+        int num_args = 3;
+        while(num_args < argc && std::string(argv[num_args]).compare(0, 2, "--") != 0) num_args++;
+        double pos_tol = (num_args > 3) ? std::atof(argv[3]) : 1.0e-4;
+        double dens_tol = (num_args > 4) ? std::atof(argv[4]) : 1.0e-3;
+        double height_tol = (num_args > 5) ? std::atof(argv[5]) : 1.0e-4;
+        TrajectoryVariant variant;
+        for(int k = num_args; k < argc; k++) {
+            std::string option = argv[k];
+            if(option == "--deterministic") {
+                variant.deterministic = true;
+            } else if(option == "--compact") {
+                variant.compact_state = true;
+            } else if(option == "--tuned-grid") {
+                variant.tune_grid = true;
+            } else if(option == "--no-sleep") {
+                variant.sleeping = false;
+            } else if(option == "--mixed") {
+                variant.mixed_precision = true;
+            } else if(option == "--decomposed" && k+1 < argc && std::atoi(argv[k+1]) > 0) {
+                variant.num_subdomains = std::atoi(argv[++k]);
+            } else {
+                std::cerr << "Unknown option " << option << std::endl;
+                return 1;
+            }
+        }
+        if(variant.mixed_precision && variant.num_subdomains > 1) {
+            std::cerr << "Decomposed runs are single precision" << std::endl;
+            return 1;
+        }
+        return CompareTrajectory(argv[2], Tolerance(pos_tol, dens_tol, height_tol), variant);
+    }
+
+    // scenario to view
+    Scenario scenario;
+    if(argc > 1 && !LoadScenario(argv[1], &scenario)) exit(1);
+
+    // window and context
+    GLFWwindow *window = InitContext(window_width, window_height, true);
+
+    // register callback functions
+    glfwSetCursorPosCallback(window, glfwCursorPosCallBack);
+    glfwSetMouseButtonCallback(window, glfwMouseButtonCallBack);
+    glfwSetKeyCallback(window, glfwKeyCallBack);
+    glfwSetFramebufferSizeCallback(window, glfwFramebufferSizeCallBack);
 
     // create a scene
-    scene = std::make_unique<Scene>(window_width, window_height);
+    scene = std::make_unique<Scene>(window_width, window_height, scenario);
 
     // set timer
     float current_time = 0.0f;
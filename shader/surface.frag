@@ -0,0 +1,22 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec3 frag_pos;
+in vec3 frag_normal;
+
+struct Light {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+};
+
+uniform Light light;
+uniform vec3 color;
+
+void main() {
+    vec3 normal = normalize(frag_normal);
+    float diff = max(dot(normal, -light.direction), 0.0);
+    vec3 result = (light.ambient + diff * light.diffuse) * color;
+    FragColor = vec4(result, 1.0f);
+}
\ No newline at end of file
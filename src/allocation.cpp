@@ -0,0 +1,100 @@
+/**
+ * @file allocation.cpp
+ * @brief Implementation of heap allocation counting
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "allocation.hpp"
+
+// global operator new is replaced for the whole program, counting is off unless requested
+
+static std::atomic<bool> counting(false);
+static std::atomic<long long> num_allocations(0);
+static std::atomic<size_t> allocated_bytes(0);
+
+/**
+ * @brief allocate and count if counting
+ * @param[in] size bytes
+ * @return memory
+ */
+static void *Allocate(size_t size) {
+    if(counting.load(std::memory_order_relaxed)) {
+        num_allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if(p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size) {
+    return Allocate(size);
+}
+
+void *operator new[](size_t size) {
+    return Allocate(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return Allocate(size);
+    } catch(...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return Allocate(size);
+    } catch(...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+/**
+ * @brief start or stop counting, counters are reset on start
+ * @param[in] enable counting or not
+ */
+void SetAllocationCounting(bool enable) {
+    if(enable) {
+        num_allocations = 0;
+        allocated_bytes = 0;
+    }
+    counting = enable;
+}
+
+/**
+ * @brief get number of allocations since counting started
+ * @return number of allocations
+ */
+long long GetNumAllocations() {
+    return num_allocations;
+}
+
+/**
+ * @brief get bytes allocated since counting started
+ * @return bytes
+ */
+size_t GetAllocatedBytes() {
+    return allocated_bytes;
+}
\ No newline at end of file
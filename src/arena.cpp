@@ -0,0 +1,72 @@
+/**
+ * @file arena.cpp
+ * @brief Implementation of scratch arena
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "arena.hpp"
+
+/**
+ * @brief constructor
+ */
+Arena::Arena()
+: capacity_(0), offset_(0), peak_(0), overflow_size_(0) {
+
+}
+
+/**
+ * @brief destructor
+ */
+Arena::~Arena() {
+
+}
+
+/**
+ * @brief release all arrays, and grow block to peak if it overflowed
+ */
+void Arena::Reset() {
+    peak_ = std::max(peak_, offset_ + overflow_size_);
+    if(!overflow_.empty()) {
+        // headroom keeps a slowly growing workload from overflowing every step
+        overflow_.clear();
+        capacity_ = peak_ + peak_ / 2;
+        block_.reset(new char[capacity_]);
+    }
+    offset_ = 0;
+    overflow_size_ = 0;
+}
+
+/**
+ * @brief get size of block
+ * @return bytes
+ */
+size_t Arena::GetCapacity() const {
+    return capacity_;
+}
+
+/**
+ * @brief get largest usage between resets
+ * @return bytes
+ */
+size_t Arena::GetPeak() const {
+    return std::max(peak_, offset_ + overflow_size_);
+}
+
+/**
+ * @brief allocate aligned bytes from block, or from a new overflow block
+ * @param[in] size bytes
+ * @param[in] align alignment
+ * @return memory
+ */
+void *Arena::AllocateBytes(size_t size, size_t align) {
+    size_t begin = (offset_ + align - 1) / align * align;
+    if(begin + size <= capacity_) {
+        offset_ = begin + size;
+        return block_.get() + begin;
+    }
+    // new[] of char is aligned for any fundamental type
+    overflow_.emplace_back(new char[size + align]);
+    overflow_size_ += size + align;
+    return overflow_.back().get();
+}
\ No newline at end of file
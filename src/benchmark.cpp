@@ -0,0 +1,701 @@
+/**
+ * @file benchmark.cpp
+ * @brief Implementation of benchmarks
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "benchmark.hpp"
+
+/**
+ * @brief advance simulation and measure wall time
+ * @param[in,out] simulater simulater
+ * @param[in] num_steps number of steps
+ * @return elapsed seconds
+ */
+template<typename Real, typename Accum>
+static double Advance(Simulater<Real, Accum> *simulater, int num_steps) {
+    auto start = std::chrono::steady_clock::now();
+    for(int step = 0; step < num_steps; step++) {
+        simulater->Evolve();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/**
+ * @brief print timing and error against reference run
+ * @param[in] name name of precision
+ * @param[in] seconds elapsed seconds
+ * @param[in] num_steps number of steps
+ * @param[in] simulater simulater
+ * @param[in] reference reference simulater in double precision
+ */
+template<typename Real, typename Accum>
+static void Report(const std::string &name, double seconds, int num_steps, const Simulater<Real, Accum> &simulater, const Simulater<double> &reference) {
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << seconds
+              << std::setw(12) << 1000.0 * seconds / num_steps;
+
+    const auto &pos = simulater.GetPositions();
+    const auto &height = simulater.GetHeights();
+    const auto &ref_pos = reference.GetPositions();
+    const auto &ref_height = reference.GetHeights();
+    const auto &attr = reference.GetAttributes();
+    if(pos.size() != ref_pos.size()) {
+        std::cout << "  particle count differs from reference" << std::endl;
+        return;
+    }
+
+    double pos_err = 0.0;
+    double height_err = 0.0;
+    int n = 0;
+    for(int i = 0; i < pos.size(); i++) {
+        if(attr[i] != kFluid) continue;
+        glm::dvec2 d = glm::dvec2(pos[i]) - ref_pos[i];
+        pos_err += glm::dot(d, d);
+        height_err += (height[i] - ref_height[i]) * (height[i] - ref_height[i]);
+        n++;
+    }
+    std::cout << std::scientific << std::setprecision(3)
+              << std::setw(14) << std::sqrt(pos_err / glm::max(n, 1))
+              << std::setw(14) << std::sqrt(height_err / glm::max(n, 1)) << std::endl;
+}
+
+/**
+ * @brief compare float, double and mixed precision on the same scene
+ * @param[in] scale scale of domain
+ * @param[in] num_steps number of steps
+ * @return exit status
+ */
+int RunPrecisionBenchmark(float scale, int num_steps) {
+    Simulater<double> reference(scale);
+    Simulater<float> single(scale);
+    Simulater<float, double> mixed(scale);
+
+    double reference_time = Advance(&reference, num_steps);
+    double single_time = Advance(&single, num_steps);
+    double mixed_time = Advance(&mixed, num_steps);
+
+    std::cout << reference.GetNumParticles(kFluid) << " fluid particles, " << num_steps << " steps" << std::endl;
+    std::cout << "mode     seconds     ms/step   rms pos err  rms height err" << std::endl;
+    Report("double", reference_time, num_steps, reference, reference);
+    Report("float", single_time, num_steps, single, reference);
+    Report("mixed", mixed_time, num_steps, mixed, reference);
+    return 0;
+}
+
+/**
+ * @brief sweep parameters of scenario and report strong or weak scaling over subdomains at each number of threads
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps
+ * @return exit status
+ */
+int RunSweep(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    std::vector<float> scales = scenario.sweep_scales.empty() ? std::vector<float>({scenario.scale}) : scenario.sweep_scales;
+    std::vector<int> subdomains = scenario.sweep_subdomains.empty() ? std::vector<int>({1}) : scenario.sweep_subdomains;
+    std::vector<std::string> kernels = scenario.sweep_kernels.empty() ? std::vector<std::string>({scenario.kernel}) : scenario.sweep_kernels;
+    std::vector<int> threads = scenario.sweep_threads.empty() ? std::vector<int>({int(glm::max(std::thread::hardware_concurrency(), 1u))}) : scenario.sweep_threads;
+
+    std::cout << (scenario.weak_scaling ? "weak" : "strong") << " scaling, " << num_steps << " steps" << std::endl;
+    std::cout << "   scale  kernel   threads  subdomains  particles    seconds    ms/step  speedup  efficiency" << std::endl;
+    for(float scale: scales) {
+        for(const std::string &kernel: kernels) {
+            for(int num_threads: threads) {
+                double base_seconds = 0.0;
+                for(int k = 0; k < subdomains.size(); k++) {
+                    // weak scaling keeps particles per subdomain by growing area with subdomains
+                    int p = subdomains[k];
+                    Scenario config = scenario;
+                    config.scale = scenario.weak_scaling ? scale * std::sqrt((float)p / subdomains[0]) : scale;
+                    config.kernel = kernel;
+
+                    double seconds;
+                    int num_fluid;
+                    if(RunDecomposed(config, p, num_steps, false, &seconds, &num_fluid, nullptr, 1, nullptr, num_threads) != 0) {
+                        std::cerr << "Failed to run " << p << " subdomains" << std::endl;
+                        return 1;
+                    }
+                    if(k == 0) base_seconds = seconds;
+                    double ratio = (double)p / subdomains[0];
+                    double efficiency = scenario.weak_scaling ? base_seconds / seconds : base_seconds / seconds / ratio;
+                    double speedup = efficiency * ratio;
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(8) << config.scale
+                              << "  " << std::left << std::setw(8) << kernel << std::right
+                              << std::setw(8) << num_threads
+                              << std::setw(12) << p
+                              << std::setw(11) << num_fluid
+                              << std::setprecision(3) << std::setw(11) << seconds
+                              << std::setw(11) << 1000.0 * seconds / num_steps
+                              << std::setprecision(2) << std::setw(9) << speedup
+                              << std::setw(12) << efficiency << std::endl;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief check that steady state steps perform no heap allocation
+ * @param[in] scenario scenario
+ * @param[in] num_warmup number of steps before counting, so that buffers reach their sizes
+ * @param[in] num_steps number of counted steps
+ * @return exit status, failure if any allocation was counted
+ */
+int RunAllocationCheck(const Scenario &scenario, int num_warmup, int num_steps) {
+    // several threads so that pooled stages are covered, surface resampled as the viewer would
+    Simulater<float> simulater(scenario);
+    simulater.SetMaxThreads(4);
+    for(int step = 0; step < num_warmup; step++) {
+        simulater.Evolve();
+        simulater.UpdateSurface();
+    }
+
+    SetAllocationCounting(true);
+    for(int step = 0; step < num_steps; step++) {
+        simulater.Evolve();
+        simulater.UpdateSurface();
+    }
+    SetAllocationCounting(false);
+
+    long long num_allocations = GetNumAllocations();
+    std::cout << num_allocations << " allocations (" << GetAllocatedBytes() << " bytes) in " << num_steps << " steps after " << num_warmup << " warmup steps" << std::endl;
+    if(num_allocations > 0) {
+        std::cout << "FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief run scenario with gauges and report cost of sampling
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps
+ * @return exit status
+ */
+int RunGauges(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    if(scenario.gauges.empty()) {
+        std::cerr << path << ": no gauges" << std::endl;
+        return 1;
+    }
+
+    Simulater<float> simulater(scenario);
+    Statistics stats;
+    double total = 0.0;
+    double sampling = 0.0;
+    for(int step = 0; step < num_steps; step++) {
+        simulater.Evolve();
+        simulater.GetStatistics(&stats);
+        for(int s = 0; s < kNumStages; s++) total += stats.stage_time[s];
+        sampling += stats.stage_time[kStageGauge];
+    }
+    int num_samples = num_steps / scenario.gauge_interval;
+    std::cout << scenario.gauges.size() << " gauges, " << num_samples << " samples to " << scenario.gauge_path << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+              << 1000.0 * total / num_steps << " ms/step, "
+              << 1000.0 * sampling / glm::max(num_samples, 1) << " ms/sample ("
+              << 100.0 * sampling / total << "% of run)" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief tune grid of scenario and compare search time with the default grid
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps
+ * @return exit status
+ */
+int RunGridTuning(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    if(scenario.variable_smoothing) {
+        std::cerr << path << ": grid is tuned only for fixed smoothing length" << std::endl;
+        return 1;
+    }
+    Scenario config = scenario;
+    config.tune_grid = true;
+    Simulater<float> tuned(config);
+    config.tune_grid = false;
+    config.cell_ratio = 0.0f;
+    Simulater<float> reference(config);
+
+    // first trial is the default power of two division
+    const std::vector<GridTrial> &trials = tuned.GetGridTrials();
+    std::cout << "cell width  ratio  ms/search pass  cells/search  candidates/hit" << std::endl;
+    for(int k = 0; k < trials.size(); k++) {
+        const GridTrial &trial = trials[k];
+        std::cout << std::fixed << std::setprecision(4) << std::setw(10) << trial.cell_width
+                  << std::setprecision(2) << std::setw(7) << trial.cell_width / tuned.GetEffectiveRadius()
+                  << std::setprecision(3) << std::setw(16) << 1000.0 * trial.seconds
+                  << std::setprecision(2) << std::setw(14) << trial.cells_per_search
+                  << std::setw(16) << trial.candidates_per_hit
+                  << (k == 0 ? "  default" : "")
+                  << (trial.cell_width == tuned.GetCellWidth() ? "  chosen" : "") << std::endl;
+    }
+
+    Statistics stats;
+    double tuned_seconds = 0.0;
+    double reference_seconds = 0.0;
+    for(int step = 0; step < num_steps; step++) {
+        tuned.Evolve();
+        tuned.GetStatistics(&stats);
+        tuned_seconds += stats.stage_time[kStageNeighbor];
+        reference.Evolve();
+        reference.GetStatistics(&stats);
+        reference_seconds += stats.stage_time[kStageNeighbor];
+    }
+    std::cout << "neighbor search over " << num_steps << " steps: "
+              << std::setprecision(3) << 1000.0 * reference_seconds / num_steps << " ms/step default, "
+              << 1000.0 * tuned_seconds / num_steps << " ms/step tuned" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief run scenario over simulated duration and check that energy did not grow
+ * @param[in] config scenario
+ * @param[in] duration simulated seconds
+ * @param[out] num_steps number of steps
+ * @param[out] seconds elapsed seconds
+ * @param[out] drift change of energy per unit mass of fluid per simulated second
+ * @param[out] iterations mean iterations of viscosity solve per step
+ * @return stable or not
+ */
+static bool RunStability(const Scenario &config, double duration, int *num_steps, double *seconds, double *drift, double *iterations) {
+    Simulater<float> simulater(config);
+    *num_steps = (int)std::round(duration / config.dt);
+    double energy = simulater.GetEnergy();
+    long long total_iterations = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int step = 0; step < *num_steps; step++) {
+        simulater.Evolve();
+        total_iterations += simulater.GetViscosityIterations();
+    }
+    auto end = std::chrono::steady_clock::now();
+    *seconds = std::chrono::duration<double>(end - start).count();
+    *drift = (simulater.GetEnergy() - energy) / simulater.GetTime();
+    *iterations = (double)total_iterations / glm::max(*num_steps, 1);
+
+    // a closed basin with viscosity only loses energy, so any gain means instability
+    bool stable = std::isfinite(*drift) && *drift <= 0.0;
+    for(const auto &pos: simulater.GetPositions()) stable = stable && std::isfinite(pos[0]) && std::isfinite(pos[1]);
+    return stable;
+}
+
+/**
+ * @brief compare integrators over growing time steps by cost per simulated second and energy drift
+ * @param[in] scenario scenario, its time step is the smallest one tried
+ * @param[in] duration simulated seconds of each run
+ * @return exit status
+ */
+int RunIntegratorBenchmark(const Scenario &scenario, double duration) {
+    std::vector<int> dt_scales = {1, 2, 4, 8, 16, 32};
+    std::vector<float> max_stable_dt(kNumIntegrators, 0.0f);
+    std::vector<bool> unstable(kNumIntegrators, false);
+
+    std::cout << duration << " simulated seconds per run, energy per unit mass of fluid" << std::endl;
+    std::cout << "integrator                 dt   steps    seconds  wall/sim  drift [J/kg/s]  stable" << std::endl;
+    for(int scale: dt_scales) {
+        for(int k = 0; k < kNumIntegrators; k++) {
+            Scenario config = scenario;
+            config.dt = scenario.dt * scale;
+            config.integrator = (Integrator)k;
+            int num_steps;
+            double seconds, drift, iterations;
+            bool stable = RunStability(config, duration, &num_steps, &seconds, &drift, &iterations);
+
+            // largest of time steps that are stable together with all smaller ones
+            unstable[k] = unstable[k] || !stable;
+            if(!unstable[k]) max_stable_dt[k] = config.dt;
+
+            std::cout << std::left << std::setw(20) << kIntegratorName[k] << std::right
+                      << std::fixed << std::setprecision(4) << std::setw(9) << config.dt
+                      << std::setw(8) << num_steps
+                      << std::setprecision(3) << std::setw(11) << seconds
+                      << std::setprecision(2) << std::setw(10) << seconds / duration
+                      << std::scientific << std::setprecision(3) << std::setw(16) << drift
+                      << "  " << (stable ? "yes" : "no") << std::endl;
+        }
+    }
+
+    std::cout << "largest stable dt:";
+    for(int k = 0; k < kNumIntegrators; k++) {
+        std::cout << "  " << kIntegratorName[k] << " " << std::fixed << std::setprecision(4) << max_stable_dt[k];
+    }
+    std::cout << std::endl;
+    return 0;
+}
+
+/**
+ * @brief compare explicit and implicit viscosity over growing time steps
+ * @param[in] scenario scenario, its time step is the smallest one tried
+ * @param[in] duration simulated seconds of each run
+ * @return exit status
+ */
+int RunViscosityBenchmark(const Scenario &scenario, double duration) {
+    std::vector<int> dt_scales = {1, 2, 4, 8, 16};
+    float max_stable_dt[2] = {0.0f, 0.0f};
+    bool unstable[2] = {false, false};
+
+    float max_visc = 0.0f;
+    for(const Phase &phase: scenario.phases) max_visc = glm::max(max_visc, phase.visc);
+    std::cout << duration << " simulated seconds per run, max viscosity " << max_visc << std::endl;
+    std::cout << "viscosity       dt   steps    seconds  wall/sim  cg iter  drift [J/kg/s]  stable" << std::endl;
+    for(int scale: dt_scales) {
+        for(int implicit = 0; implicit < 2; implicit++) {
+            Scenario config = scenario;
+            config.dt = scenario.dt * scale;
+            config.implicit_viscosity = implicit;
+
+            int num_steps;
+            double seconds, drift, iterations;
+            bool stable = RunStability(config, duration, &num_steps, &seconds, &drift, &iterations);
+            unstable[implicit] = unstable[implicit] || !stable;
+            if(!unstable[implicit]) max_stable_dt[implicit] = config.dt;
+
+            std::cout << std::left << std::setw(10) << (implicit ? "implicit" : "explicit") << std::right
+                      << std::fixed << std::setprecision(4) << std::setw(8) << config.dt
+                      << std::setw(8) << num_steps
+                      << std::setprecision(3) << std::setw(11) << seconds
+                      << std::setprecision(2) << std::setw(10) << seconds / duration
+                      << std::setprecision(1) << std::setw(9) << iterations
+                      << std::scientific << std::setprecision(3) << std::setw(16) << drift
+                      << "  " << (stable ? "yes" : "no") << std::endl;
+        }
+    }
+    std::cout << "largest stable dt:  explicit " << std::fixed << std::setprecision(4) << max_stable_dt[0]
+              << "  implicit " << max_stable_dt[1] << std::endl;
+    return 0;
+}
+
+/**
+ * @brief run ensemble of scenario and report throughput and spread of outcomes
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps of each member
+ * @param[in] num_workers number of concurrent members, 0 for number of cores
+ * @return exit status
+ */
+int RunEnsemble(const std::string &path, int num_steps, int num_workers) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    if(scenario.num_members == 0) {
+        std::cerr << path << ": no ensemble" << std::endl;
+        return 1;
+    }
+
+    Ensemble ensemble(scenario);
+    ensemble.Run(num_steps, num_workers);
+    const std::vector<MemberResult> &results = ensemble.GetResults();
+
+    // busy time of workers over their wall time
+    double busy = 0.0;
+    long long particle_steps = 0;
+    int num_finite = 0;
+    for(const MemberResult &result: results) {
+        busy += result.seconds;
+        particle_steps += (long long)result.num_particles * result.num_steps;
+        if(result.finite) num_finite++;
+    }
+    double seconds = ensemble.GetSeconds();
+    std::cout << ensemble.GetNumMembers() << " members, " << num_steps << " steps, " << ensemble.GetNumWorkers() << " workers" << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << seconds << " s, "
+              << ensemble.GetNumMembers() / seconds << " members/s, "
+              << std::scientific << std::setprecision(3) << particle_steps / seconds << " particle steps/s, "
+              << std::fixed << std::setprecision(1) << 100.0 * busy / (seconds * ensemble.GetNumWorkers()) << "% worker utilization" << std::endl;
+    if(num_finite < results.size()) std::cout << results.size() - num_finite << " members diverged" << std::endl;
+
+    // spread of outcomes over members that stayed finite
+    auto summarize = [&](const std::string &name, const std::function<double(const MemberResult &)> &value) {
+        std::vector<double> values;
+        for(const MemberResult &result: results) {
+            if(result.finite) values.push_back(value(result));
+        }
+        if(values.empty()) return;
+        std::sort(values.begin(), values.end());
+        double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+        double var = 0.0;
+        for(double v: values) var += (v - mean) * (v - mean);
+        auto quantile = [&](double q) { return values[(int)std::round(q * (values.size() - 1))]; };
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(4)
+                  << std::setw(10) << mean << std::setw(10) << std::sqrt(var / values.size())
+                  << std::setw(10) << values.front() << std::setw(10) << quantile(0.05) << std::setw(10) << quantile(0.5)
+                  << std::setw(10) << quantile(0.95) << std::setw(10) << values.back() << std::endl;
+    };
+    std::cout << "                  mean       std       min        p5       p50       p95       max" << std::endl;
+    summarize("max height", [](const MemberResult &result) { return (double)result.max_height; });
+    summarize("energy", [](const MemberResult &result) { return result.energy; });
+
+    if(!ensemble.Write(scenario.ensemble_path)) return 1;
+    std::cout << "members written to " << scenario.ensemble_path << std::endl;
+    return 0;
+}
+
+/**
+ * @brief run periodic scenario, check particles stay in domain and compare with closed domain
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps
+ * @return exit status, failure if a particle left domain or state diverged
+ */
+int RunPeriodic(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    if(!scenario.periodic[0] && !scenario.periodic[1]) {
+        std::cerr << path << ": no periodic axis" << std::endl;
+        return 1;
+    }
+    Scenario config = scenario;
+    config.periodic = glm::bvec2(false);
+    Simulater<float> periodic(scenario);
+    Simulater<float> closed(config);
+
+    // particle jumping more than half of period between steps crossed domain
+    float period = scenario.scale;
+    std::vector<glm::vec2> prev_pos = periodic.GetPositions();
+    std::vector<int> prev_ids = periodic.GetIds();
+    Statistics stats;
+    double periodic_seconds = 0.0;
+    double closed_seconds = 0.0;
+    long long num_wraps = 0;
+    int num_outside = 0;
+    for(int step = 0; step < num_steps; step++) {
+        periodic.Evolve();
+        periodic.GetStatistics(&stats);
+        periodic_seconds += stats.stage_time[kStageNeighbor];
+        closed.Evolve();
+        closed.GetStatistics(&stats);
+        closed_seconds += stats.stage_time[kStageNeighbor];
+
+        const std::vector<glm::vec2> &pos = periodic.GetPositions();
+        const std::vector<int> &ids = periodic.GetIds();
+        for(int i = 0; i < pos.size(); i++) {
+            for(int a = 0; a < 2; a++) {
+                if(!scenario.periodic[a]) continue;
+                if(!std::isfinite(pos[i][a]) || glm::abs(pos[i][a]) > period / 2) num_outside++;
+                if(i < prev_ids.size() && ids[i] == prev_ids[i] && glm::abs(pos[i][a] - prev_pos[i][a]) > period / 2) num_wraps++;
+            }
+        }
+        prev_pos = pos;
+        prev_ids = ids;
+    }
+    std::cout << periodic.GetNumParticles(kFluid) << " particles, " << num_wraps << " crossings of periodic sides in " << num_steps << " steps" << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "neighbor search: "
+              << 1000.0 * periodic_seconds / num_steps << " ms/step periodic, "
+              << 1000.0 * closed_seconds / num_steps << " ms/step closed" << std::endl;
+    if(num_outside > 0) {
+        std::cout << num_outside << " positions outside domain" << std::endl;
+        std::cout << "FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief cull particles of scenario for camera poses and report how many are left to draw
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps before culling
+ * @return exit status
+ */
+int RunCulling(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    Simulater<float> simulater(scenario);
+    for(int step = 0; step < num_steps; step++) simulater.Evolve();
+
+    std::vector<glm::vec2> pos = simulater.GetPositions();
+    std::vector<float> height = simulater.GetHeights();
+    std::vector<glm::vec3> col(pos.size(), glm::vec3(0.0f));
+    float half = scenario.scale / 2;
+    ParticleRenderer renderer(glm::vec2(-half), glm::vec2(half), 16);
+    auto start = std::chrono::steady_clock::now();
+    renderer.Update(pos, height, col);
+    double binning = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // same lens as scene, eye and target relative to domain
+    struct Pose {
+        const char *name;
+        glm::vec3 eye;
+        glm::vec3 target;
+    };
+    std::vector<Pose> poses = {
+        {"overview", glm::vec3(0.0f, 1.25f, 1.25f), glm::vec3(0.0f)},
+        {"distant", glm::vec3(0.0f, 2.5f, 2.5f), glm::vec3(0.0f)},
+        {"top-down", glm::vec3(0.25f, 0.25f, 0.25f), glm::vec3(0.25f, 0.0f, 0.2f)},
+        {"corner", glm::vec3(-0.6f, 0.1f, -0.6f), glm::vec3(-0.2f, 0.0f, -0.6f)},
+    };
+    std::cout << renderer.GetNumParticles() << " particles in " << renderer.GetNumCells() << " cells, binned in "
+              << std::fixed << std::setprecision(3) << 1000.0 * binning << " ms" << std::endl;
+    std::cout << "pose        cells  culled  culled+lod    ms/cull" << std::endl;
+    for(const Pose &pose: poses) {
+        Camera camera(pose.eye * scenario.scale, pose.target * scenario.scale, glm::vec3(0.0f, 1.0f, 0.0f), 45.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+        std::array<glm::vec4, 6> frustum = camera.GenFrustum();
+        float lod_distance = renderer.GetLodDistance();
+        renderer.SetLodDistance(0.0f);
+        int culled = renderer.Cull(frustum, camera.GetPosition());
+        renderer.SetLodDistance(lod_distance);
+        int num_repeats = 100;
+        start = std::chrono::steady_clock::now();
+        int decimated = 0;
+        for(int k = 0; k < num_repeats; k++) decimated = renderer.Cull(frustum, camera.GetPosition());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / num_repeats;
+        std::cout << std::left << std::setw(10) << pose.name << std::right
+                  << std::setw(7) << renderer.GetNumVisibleCells()
+                  << std::setprecision(1) << std::setw(7) << 100.0 * culled / renderer.GetNumParticles() << "%"
+                  << std::setw(11) << 100.0 * decimated / renderer.GetNumParticles() << "%"
+                  << std::setprecision(4) << std::setw(11) << 1000.0 * seconds << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * @brief error of positions and heights of fluid particles against reference, matched by id
+ * @param[in] simulater simulater
+ * @param[in] reference reference simulater in double precision
+ * @param[out] pos_err maximum and root mean square position error
+ * @param[out] height_err maximum and root mean square height error
+ */
+template<typename Real, typename Accum>
+static void CompareById(const Simulater<Real, Accum> &simulater, const Simulater<double> &reference, glm::dvec2 *pos_err, glm::dvec2 *height_err) {
+    std::unordered_map<int, int> index;
+    const auto &ref_ids = reference.GetIds();
+    for(int i = 0; i < ref_ids.size(); i++) index[ref_ids[i]] = i;
+
+    const auto &pos = simulater.GetPositions();
+    const auto &height = simulater.GetHeights();
+    const auto &ids = simulater.GetIds();
+    const auto &attr = simulater.GetAttributes();
+    *pos_err = glm::dvec2(0.0);
+    *height_err = glm::dvec2(0.0);
+    int n = 0;
+    for(int i = 0; i < pos.size(); i++) {
+        if(attr[i] != kFluid) continue;
+        auto it = index.find(ids[i]);
+        if(it == index.end()) continue;
+        double dp = glm::length(glm::dvec2(pos[i]) - reference.GetPositions()[it->second]);
+        double dh = glm::abs(double(height[i]) - reference.GetHeights()[it->second]);
+        *pos_err = glm::dvec2(glm::max((*pos_err)[0], dp), (*pos_err)[1] + dp * dp);
+        *height_err = glm::dvec2(glm::max((*height_err)[0], dh), (*height_err)[1] + dh * dh);
+        n++;
+    }
+    (*pos_err)[1] = std::sqrt((*pos_err)[1] / glm::max(n, 1));
+    (*height_err)[1] = std::sqrt((*height_err)[1] / glm::max(n, 1));
+}
+
+/**
+ * @brief compare size of compact snapshots with full precision state and accuracy of state rounded to them
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps
+ * @return exit status
+ */
+int RunCompact(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    scenario.compact_state = false;
+    Scenario config = scenario;
+    config.compact_state = true;
+    Simulater<double> reference(scenario);
+    Simulater<float> full(scenario);
+    Simulater<float> compact(config);
+    Advance(&reference, num_steps);
+    Advance(&full, num_steps);
+    Advance(&compact, num_steps);
+
+    // bytes of particle arrays against compact snapshot of same particles
+    Statistics stats;
+    full.GetStatistics(&stats);
+    size_t full_bytes = 0;
+    for(const auto &entry: stats.memory) {
+        if(entry.first == "particles") full_bytes = entry.second;
+    }
+    CompactParticles state;
+    auto start = std::chrono::steady_clock::now();
+    full.Compact(&state);
+    double encode = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Simulater<float> restored(scenario);
+    start = std::chrono::steady_clock::now();
+    restored.Expand(state);
+    double decode = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int n = full.GetIds().size();
+    std::cout << n << " particles, " << state.GetNumPhases() << " phases, " << num_steps << " steps" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "bytes/particle: "
+              << double(full_bytes) / n << " full state, " << double(state.GetMemoryUsage()) / glm::max(state.GetNumParticles(), 1) << " compact snapshot (boundary left out)" << std::endl;
+    std::cout << std::setprecision(3) << "encode " << 1000.0 * encode << " ms, decode " << 1000.0 * decode << " ms" << std::endl;
+
+    std::cout << "state        max pos     rms pos  max height  rms height" << std::endl;
+    auto print = [](const std::string &name, const glm::dvec2 &pos_err, const glm::dvec2 &height_err) {
+        std::cout << std::left << std::setw(10) << name << std::right << std::scientific << std::setprecision(3)
+                  << std::setw(12) << pos_err[0] << std::setw(12) << pos_err[1]
+                  << std::setw(12) << height_err[0] << std::setw(12) << height_err[1] << std::endl;
+    };
+    glm::dvec2 pos_err, height_err;
+    CompareById(full, reference, &pos_err, &height_err);
+    print("full", pos_err, height_err);
+    CompareById(compact, reference, &pos_err, &height_err);
+    print("compact", pos_err, height_err);
+
+    // round trip of one snapshot
+    std::unordered_map<int, int> index;
+    for(int i = 0; i < full.GetIds().size(); i++) index[full.GetIds()[i]] = i;
+    double round_trip = 0.0;
+    for(int i = 0; i < restored.GetIds().size(); i++) {
+        auto it = index.find(restored.GetIds()[i]);
+        if(it == index.end()) continue;
+        round_trip = glm::max(round_trip, (double)glm::length(restored.GetPositions()[i] - full.GetPositions()[it->second]));
+    }
+    std::cout << "round trip: " << restored.GetIds().size() << " particles, max position error " << round_trip << std::endl;
+    return 0;
+}
+
+/**
+ * @brief add tracer phases to scenario and time steps, cost should not grow with number of phases
+ * @param[in] path scenario file
+ * @param[in] num_steps number of steps
+ * @return exit status
+ */
+int RunPhaseScaling(const std::string &path, int num_steps) {
+    Scenario scenario;
+    if(!LoadScenario(path, &scenario)) return 1;
+    std::cout << "phases   ms/step  mixture ms  bytes/particle" << std::endl;
+    for(int num_tracers: {0, 8, 32, 64}) {
+        // tracers carry properties of first fluid phase, each region seeded with a tenth of one
+        Scenario config = scenario;
+        int num_phases = scenario.phases.size();
+        for(int t = 0; t < num_tracers; t++) {
+            Phase tracer = scenario.phases[1];
+            tracer.col = glm::vec3(float(t) / num_tracers, 0.2f, 1.0f - float(t) / num_tracers);
+            config.phases.push_back(tracer);
+        }
+        for(int r = 0; r < config.regions.size(); r++) {
+            std::vector<float> &frac = config.regions[r].frac;
+            frac.resize(config.phases.size(), 0.0f);
+            if(num_tracers == 0) continue;
+            for(float &f: frac) f *= 0.9f;
+            frac[num_phases + r % num_tracers] = 0.1f;
+        }
+
+        Simulater<float> simulater(config);
+        Statistics stats;
+        double mixture = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for(int step = 0; step < num_steps; step++) {
+            simulater.Evolve();
+            simulater.GetStatistics(&stats);
+            mixture += stats.stage_time[kStageMixture] + stats.stage_time[kStageColor] + stats.stage_time[kStageRefine];
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t bytes = 0;
+        for(const auto &entry: stats.memory) {
+            if(entry.first == "particles") bytes = entry.second;
+        }
+        std::cout << std::setw(6) << config.phases.size() << std::fixed << std::setprecision(3)
+                  << std::setw(10) << 1000.0 * seconds / num_steps
+                  << std::setw(12) << 1000.0 * mixture / num_steps
+                  << std::setprecision(1) << std::setw(16) << double(bytes) / simulater.GetIds().size() << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -46,6 +46,19 @@ glm::mat4 Camera::GenProjectionMatrix() {
     return projection;
 }
 
+/**
+ * @brief generate planes of view frustum from rows of view projection matrix
+ * @return left, right, bottom, top, near and far planes, (normal, offset) with normal pointing inward
+ */
+std::array<glm::vec4, 6> Camera::GenFrustum() {
+    glm::mat4 m = GenProjectionMatrix() * GenViewMatrix();
+    glm::vec4 row[4];
+    for(int i = 0; i < 4; i++) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    std::array<glm::vec4, 6> planes = {row[3] + row[0], row[3] - row[0], row[3] + row[1], row[3] - row[1], row[3] + row[2], row[3] - row[2]};
+    for(glm::vec4 &plane: planes) plane /= glm::length(glm::vec3(plane));
+    return planes;
+}
+
 /**
  * @brief ImGui settings
  * @param[in] window window handler
@@ -64,6 +77,14 @@ void Camera::ImGui(GLFWwindow* window) {
     }
 }
 
+/**
+ * @brief get camera position
+ * @return position
+ */
+glm::vec3 Camera::GetPosition() const {
+    return position_;
+}
+
 /**
  * @brief set camera position
  * @param[in] position position
@@ -0,0 +1,175 @@
+/**
+ * @file compact.cpp
+ * @brief Implementation of compact particle state
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "compact.hpp"
+
+/**
+ * @brief constructor
+ */
+CompactParticles::CompactParticles()
+: origin_(0.0f), cell_width_(1.0f), num_cells_(1), num_phases_(0) {
+
+}
+
+/**
+ * @brief destructor
+ */
+CompactParticles::~CompactParticles() {
+
+}
+
+/**
+ * @brief remove particles and set grid
+ * @param[in] origin minimum coordinate of grid
+ * @param[in] cell_width cell width
+ * @param[in] num_cells number of cells along each axis
+ * @param[in] num_phases number of phases
+ */
+void CompactParticles::Reset(const glm::vec2 &origin, float cell_width, const glm::ivec2 &num_cells, int num_phases) {
+    origin_ = origin;
+    cell_width_ = cell_width;
+    num_cells_ = num_cells;
+    num_phases_ = num_phases;
+    cells_.clear();
+    starts_.clear();
+    offset_.clear();
+    vel_.clear();
+    phase_.clear();
+    frac_.clear();
+    mass_level_.clear();
+    smoothing_len_.clear();
+    id_.clear();
+    attr_.clear();
+    calm_steps_.clear();
+}
+
+/**
+ * @brief append particle, particles have to be added in order of cells
+ * @param[in] pos position
+ * @param[in] vel velocity
+ * @param[in] frac nonzero fractions, phases below kMaxPhases
+ * @param[in] mass_scale mass scale, a power of two
+ * @param[in] smoothing_len smoothing length
+ * @param[in] id id
+ * @param[in] attr attribute
+ * @param[in] calm_steps calm steps, saturated at 255
+ */
+void CompactParticles::Add(const glm::vec2 &pos, const glm::vec2 &vel, const fraction &frac, float mass_scale, float smoothing_len, int id, int attr, int calm_steps) {
+    uint32_t cell = GetCell(pos);
+    if(cells_.empty() || cells_.back() != cell) {
+        cells_.push_back(cell);
+        starts_.push_back(id_.size());
+    }
+    glm::vec2 lo = origin_ + glm::vec2(cell % num_cells_[0], cell / num_cells_[0]) * cell_width_;
+    glm::vec2 t = glm::clamp((pos - lo) / cell_width_, 0.0f, 1.0f);
+    offset_.push_back((uint16_t)std::lround(t[0] * 65535.0f));
+    offset_.push_back((uint16_t)std::lround(t[1] * 65535.0f));
+    vel_.push_back(FloatToHalf(vel[0]));
+    vel_.push_back(FloatToHalf(vel[1]));
+    for(int k = 0; k < kMaxPhasesPerParticle; k++) {
+        phase_.push_back(k < frac.count ? frac.phase[k] : 0);
+        frac_.push_back(k < frac.count ? EncodeFraction(frac.frac[k]) : 0);
+    }
+    mass_level_.push_back((int8_t)std::lround(std::log2(mass_scale)));
+    smoothing_len_.push_back(FloatToHalf(smoothing_len));
+    id_.push_back(id);
+    attr_.push_back(attr);
+    calm_steps_.push_back(glm::min(calm_steps, 255));
+}
+
+/**
+ * @brief decode particle
+ * @param[in] k particle index in cell order
+ * @param[out] pos position
+ * @param[out] vel velocity
+ * @param[out] frac nonzero fractions, normalized
+ * @param[out] mass_scale mass scale
+ * @param[out] smoothing_len smoothing length
+ * @param[out] id id
+ * @param[out] attr attribute
+ * @param[out] calm_steps calm steps
+ */
+void CompactParticles::Get(int k, glm::vec2 *pos, glm::vec2 *vel, fraction *frac, float *mass_scale, float *smoothing_len, int *id, int *attr, int *calm_steps) const {
+    // cell holding particle k
+    int c = std::upper_bound(starts_.begin(), starts_.end(), (uint32_t)k) - starts_.begin() - 1;
+    uint32_t cell = cells_[c];
+    glm::vec2 lo = origin_ + glm::vec2(cell % num_cells_[0], cell / num_cells_[0]) * cell_width_;
+    *pos = lo + glm::vec2(offset_[2*k], offset_[2*k+1]) / 65535.0f * cell_width_;
+    *vel = glm::vec2(HalfToFloat(vel_[2*k]), HalfToFloat(vel_[2*k+1]));
+    // fractions rounded to zero are dropped
+    float sum = 0.0f;
+    frac->count = 0;
+    for(int s = k*kMaxPhasesPerParticle; s < (k+1)*kMaxPhasesPerParticle; s++) {
+        if(frac_[s] == 0) continue;
+        frac->phase[frac->count] = phase_[s];
+        frac->frac[frac->count] = frac_[s];
+        frac->count++;
+        sum += frac_[s];
+    }
+    for(int p = 0; p < frac->count; p++) frac->frac[p] /= sum;
+    *mass_scale = std::ldexp(1.0f, mass_level_[k]);
+    *smoothing_len = HalfToFloat(smoothing_len_[k]);
+    *id = id_[k];
+    *attr = attr_[k];
+    *calm_steps = calm_steps_[k];
+}
+
+/**
+ * @brief get cell of position, clamped to grid
+ * @param[in] pos position
+ * @return cell
+ */
+int CompactParticles::GetCell(const glm::vec2 &pos) const {
+    glm::ivec2 index = glm::clamp(glm::ivec2(glm::floor((pos - origin_) / cell_width_)), glm::ivec2(0), num_cells_ - 1);
+    return index[1] * num_cells_[0] + index[0];
+}
+
+/**
+ * @brief round position to nearest one representable as 16-bit offset in its cell
+ * @param[in] pos position
+ * @return rounded position
+ */
+glm::vec2 CompactParticles::RoundPosition(const glm::vec2 &pos) const {
+    int cell = GetCell(pos);
+    glm::vec2 lo = origin_ + glm::vec2(cell % num_cells_[0], cell / num_cells_[0]) * cell_width_;
+    glm::vec2 t = glm::clamp((pos - lo) / cell_width_, 0.0f, 1.0f);
+    return lo + glm::vec2(std::lround(t[0] * 65535.0f), std::lround(t[1] * 65535.0f)) / 65535.0f * cell_width_;
+}
+
+/**
+ * @brief get number of particles
+ * @return number of particles
+ */
+int CompactParticles::GetNumParticles() const {
+    return id_.size();
+}
+
+/**
+ * @brief get number of phases
+ * @return number of phases
+ */
+int CompactParticles::GetNumPhases() const {
+    return num_phases_;
+}
+
+/**
+ * @brief get memory held by state
+ * @return bytes
+ */
+size_t CompactParticles::GetMemoryUsage() const {
+    return ::GetMemoryUsage(cells_) + ::GetMemoryUsage(starts_) + ::GetMemoryUsage(offset_) + ::GetMemoryUsage(vel_) + ::GetMemoryUsage(phase_) + ::GetMemoryUsage(frac_)
+         + ::GetMemoryUsage(mass_level_) + ::GetMemoryUsage(smoothing_len_) + ::GetMemoryUsage(id_) + ::GetMemoryUsage(attr_) + ::GetMemoryUsage(calm_steps_);
+}
+
+/**
+ * @brief quantize fraction to 8 bits, fractions of a particle are normalized when decoded
+ * @param[in] frac fraction
+ * @return quantized fraction
+ */
+uint8_t CompactParticles::EncodeFraction(float frac) {
+    return (uint8_t)std::lround(glm::clamp(frac, 0.0f, 1.0f) * 255.0f);
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+/**
+ * @file dashboard.cpp
+ * @brief Implementation of performance dashboard
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "dashboard.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] history_size number of steps kept in plots
+ */
+Dashboard::Dashboard(int history_size)
+: history_size_(history_size), offset_(0), num_records_(0) {
+    stage_history_.assign(kNumStages, std::vector<float>(history_size_, 0.0f));
+    step_history_.assign(history_size_, 0.0f);
+    interval_history_.assign(history_size_, 0.0f);
+    last_record_ = std::chrono::steady_clock::now();
+    stats_ = Statistics();
+}
+
+/**
+ * @brief destructor
+ */
+Dashboard::~Dashboard() {
+
+}
+
+/**
+ * @brief ImGui settings
+ * @param[in] window window handler
+ */
+void Dashboard::ImGui(GLFWwindow* window) {
+    if(ImGui::TreeNode("performance")) {
+        char overlay[64];
+
+        // rates
+        float step = GetAverage(step_history_);
+        float interval = GetAverage(interval_history_);
+        ImGui::Text("%.1f steps/s (%.1f steps/s in Evolve)", interval > 0.0f ? 1000.0f / interval : 0.0f, step > 0.0f ? 1000.0f / step : 0.0f);
+        std::snprintf(overlay, sizeof(overlay), "%.3f ms", step);
+        ImGui::PlotLines("step", step_history_.data(), history_size_, offset_, overlay, 0.0f, 3.4e38f, ImVec2(0, 40));
+
+        // stages
+        for(int s = 0; s < kNumStages; s++) {
+            std::snprintf(overlay, sizeof(overlay), "%.3f ms", GetAverage(stage_history_[s]));
+            ImGui::PlotLines(kStageName[s], stage_history_[s].data(), history_size_, offset_, overlay, 0.0f);
+        }
+        ImGui::Separator();
+
+        // particles
+        ImGui::Text("particles: %d boundary, %d fluid, %d ghost", stats_.num_particles[kBoundary], stats_.num_particles[kFluid], stats_.num_particles[kGhost]);
+
+        // neighbors
+        std::vector<float> hist(stats_.neighbor_hist.begin(), stats_.neighbor_hist.end());
+        std::snprintf(overlay, sizeof(overlay), "avg %.1f, max %d, bin %d", stats_.avg_neighbors, stats_.max_neighbors, stats_.neighbor_bin);
+        ImGui::PlotHistogram("neighbors", hist.data(), hist.size(), 0, overlay, 0.0f, 3.4e38f, ImVec2(0, 60));
+
+        // grid
+        float occupancy = stats_.num_cells > 0 ? 100.0f * stats_.num_occupied_cells / stats_.num_cells : 0.0f;
+        ImGui::Text("grid: %d / %d cells occupied (%.1f%%)", stats_.num_occupied_cells, stats_.num_cells, occupancy);
+        ImGui::Separator();
+
+        // memory
+        size_t total = 0;
+        for(const auto &memory: stats_.memory) {
+            ImGui::Text("%-16s %8.2f MB", memory.first.c_str(), memory.second / 1048576.0);
+            total += memory.second;
+        }
+        ImGui::Text("%-16s %8.2f MB", "total", total / 1048576.0);
+        ImGui::TreePop();
+    }
+}
+
+/**
+ * @brief record statistics of step
+ * @param[in] stats statistics
+ */
+void Dashboard::Record(const Statistics &stats) {
+    auto now = std::chrono::steady_clock::now();
+    double step = 0.0;
+    for(int s = 0; s < kNumStages; s++) {
+        stage_history_[s][offset_] = 1000.0 * stats.stage_time[s];
+        step += stats.stage_time[s];
+    }
+    step_history_[offset_] = 1000.0 * step;
+    interval_history_[offset_] = 1000.0 * std::chrono::duration<double>(now - last_record_).count();
+    last_record_ = now;
+    offset_ = (offset_ + 1) % history_size_;
+    num_records_ = glm::min(num_records_ + 1, history_size_);
+    stats_ = stats;
+}
+
+/**
+ * @brief average over recorded part of ring buffer
+ * @param[in] history ring buffer
+ * @return average
+ */
+float Dashboard::GetAverage(const std::vector<float> &history) const {
+    if(num_records_ == 0) return 0.0f;
+    float sum = 0.0f;
+    for(int k = 0; k < num_records_; k++) {
+        sum += history[(offset_ - 1 - k + history_size_) % history_size_];
+    }
+    return sum / num_records_;
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+/**
+ * @file decomposition.cpp
+ * @brief Implementation of domain decomposition
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include <sys/wait.h>
+#include <chrono>
+#include "decomposition.hpp"
+#include "simulater.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] origin origin of grid
+ * @param[in] cell_width cell width of grid
+ * @param[in] num_cells number of cells along x-axis
+ * @param[in] halo_width width of halo region
+ * @param[in] transport transport between subdomains
+ */
+Decomposition::Decomposition(const glm::vec2 &origin, float cell_width, int num_cells, float halo_width, std::unique_ptr<Transport> transport)
+: transport_(std::move(transport)), halo_width_(halo_width) {
+    int size = transport_->GetSize();
+    bounds_.resize(size+1);
+    for(int r = 0; r <= size; r++) {
+        int column = r * num_cells / size;
+        bounds_[r] = origin[0] + column * cell_width;
+    }
+}
+
+/**
+ * @brief destructor
+ */
+Decomposition::~Decomposition() {
+
+}
+
+/**
+ * @brief get rank of this subdomain
+ * @return rank
+ */
+int Decomposition::GetRank() const {
+    return transport_->GetRank();
+}
+
+/**
+ * @brief get number of subdomains
+ * @return number of subdomains
+ */
+int Decomposition::GetNumSubdomains() const {
+    return transport_->GetSize();
+}
+
+/**
+ * @brief get adjacent subdomains
+ * @return ranks of adjacent subdomains
+ */
+std::vector<int> Decomposition::GetNeighbors() const {
+    std::vector<int> neighbors;
+    int rank = GetRank();
+    if(rank > 0) neighbors.push_back(rank-1);
+    if(rank < GetNumSubdomains()-1) neighbors.push_back(rank+1);
+    return neighbors;
+}
+
+/**
+ * @brief find subdomain which owns position
+ * @param[in] pos position
+ * @return rank of owner
+ */
+int Decomposition::FindOwner(const glm::vec2 &pos) const {
+    auto it = std::upper_bound(bounds_.begin()+1, bounds_.end()-1, pos[0]);
+    return (int)(it - (bounds_.begin()+1));
+}
+
+/**
+ * @brief find adjacent subdomain to send particle to
+ * @param[in] pos position
+ * @return rank of destination
+ */
+int Decomposition::FindDestination(const glm::vec2 &pos) const {
+    int owner = FindOwner(pos);
+    int rank = GetRank();
+    return rank + glm::clamp(owner - rank, -1, 1);
+}
+
+/**
+ * @brief check position is inside this subdomain
+ * @param[in] pos position
+ * @param[in] margin margin around subdomain
+ * @return inside or not
+ */
+bool Decomposition::IsInside(const glm::vec2 &pos, float margin) const {
+    int rank = GetRank();
+    float lower = (rank == 0) ? -std::numeric_limits<float>::infinity() : bounds_[rank] - margin;
+    float upper = (rank == GetNumSubdomains()-1) ? std::numeric_limits<float>::infinity() : bounds_[rank+1] + margin;
+    return lower <= pos[0] && pos[0] < upper;
+}
+
+/**
+ * @brief check position is in halo of adjacent subdomain
+ * @param[in] pos position
+ * @param[in] rank rank of adjacent subdomain
+ * @return in halo or not
+ */
+bool Decomposition::IsInHalo(const glm::vec2 &pos, int rank) const {
+    if(rank < GetRank()) return pos[0] < bounds_[rank+1] + halo_width_;
+    return pos[0] >= bounds_[rank] - halo_width_;
+}
+
+/**
+ * @brief exchange messages with adjacent subdomains
+ * @param[in] send messages indexed by rank
+ * @param[out] recv messages indexed by rank
+ */
+void Decomposition::Exchange(const std::vector<std::vector<char>> &send, std::vector<std::vector<char>> *recv) {
+    // lower rank sends first so that a pair never blocks on both sides
+    int rank = GetRank();
+    recv->resize(GetNumSubdomains());
+    for(int n: GetNeighbors()) {
+        if(rank < n) {
+            transport_->Send(n, send[n]);
+            transport_->Receive(n, &recv->at(n));
+        } else {
+            transport_->Receive(n, &recv->at(n));
+            transport_->Send(n, send[n]);
+        }
+    }
+}
+
+/**
+ * @brief run simulation decomposed into processes on this machine
+ * @param[in] scenario scenario
+ * @param[in] num_subdomains number of subdomains
+ * @param[in] num_steps number of steps
+ * @param[in] verbose print particles of each subdomain
+ * @param[out] seconds time evolution of slowest subdomain
+ * @param[out] num_fluid fluid particles over all subdomains
+ * @param[in] snapshot packs state of subdomain at start and every interval steps, none when null
+ * @param[in] interval steps between snapshots
+ * @param[out] snapshots snapshots of each subdomain
+ * @param[in] max_threads threads of parallel stages in each subdomain, all cores when 0
+ * @return exit status
+ */
+int RunDecomposed(const Scenario &scenario, int num_subdomains, int num_steps, bool verbose, double *seconds, int *num_fluid,
+                  SnapshotFn snapshot, int interval, std::vector<std::vector<char>> *snapshots, int max_threads) {
+    // slabs along x only trade with adjacent slabs, so the two ends of a periodic x axis would never meet
+    if(scenario.periodic[0] && num_subdomains > 1) {
+        std::cerr << "Decomposition along periodic x is not supported" << std::endl;
+        return 1;
+    }
+    // ghosts would be fixed values of the implicit solve and its dot products would stay per subdomain
+    if(scenario.implicit_viscosity && num_subdomains > 1) {
+        std::cerr << "Decomposition with implicit viscosity is not supported" << std::endl;
+        return 1;
+    }
+    // split and merge pick partners among owned particles only, so slab edges would refine differently
+    if(scenario.adaptive && num_subdomains > 1) {
+        std::cerr << "Decomposition with adaptive particles is not supported" << std::endl;
+        return 1;
+    }
+
+    auto group = LocalSocketTransport::CreateGroup(num_subdomains);
+    if(group.empty()) return 1;
+
+    // each subdomain reports its timing and snapshots through its own pipe, read to end before waiting for it
+    std::vector<int> reports;
+    std::vector<pid_t> pids;
+    // subdomains already started lose their peers once the group is closed, so they fail and are reaped
+    auto fail = [&]() {
+        group.clear();
+        for(int fd: reports) close(fd);
+        for(pid_t pid: pids) waitpid(pid, nullptr, 0);
+        return 1;
+    };
+    for(int rank = 0; rank < num_subdomains; rank++) {
+        int report[2];
+        if(pipe(report) != 0) {
+            std::cerr << "Failed to create pipe" << std::endl;
+            return fail();
+        }
+        pid_t pid = fork();
+        if(pid < 0) {
+            std::cerr << "Failed to fork subdomain " << rank << std::endl;
+            close(report[0]);
+            close(report[1]);
+            return fail();
+        }
+        if(pid == 0) {
+            close(report[0]);
+            for(int fd: reports) close(fd);
+            std::unique_ptr<Transport> transport = std::move(group[rank]);
+            group.clear();
+
+            Simulater<float> simulater(scenario);
+            if(max_threads > 0) simulater.SetMaxThreads(max_threads);
+            simulater.SetDecomposition(std::move(transport));
+            std::vector<char> frames;
+            if(snapshot) snapshot(simulater, 0, &frames);
+            auto start = std::chrono::steady_clock::now();
+            for(int step = 1; step <= num_steps; step++) {
+                simulater.Evolve();
+                if(snapshot && step % interval == 0) snapshot(simulater, step, &frames);
+            }
+            auto end = std::chrono::steady_clock::now();
+            if(verbose) {
+                std::cout << "rank " << rank << ": " << simulater.GetNumParticles(kFluid) << " fluid, " << simulater.GetNumParticles(kGhost) << " ghost particles" << std::endl;
+            }
+
+            std::vector<char> buf;
+            Pack(std::chrono::duration<double>(end - start).count(), &buf);
+            Pack(simulater.GetNumParticles(kFluid), &buf);
+            buf.insert(buf.end(), frames.begin(), frames.end());
+            for(size_t offset = 0; offset < buf.size();) {
+                ssize_t written = write(report[1], buf.data() + offset, buf.size() - offset);
+                if(written <= 0) _exit(1);
+                offset += written;
+            }
+            _exit(0);
+        }
+        close(report[1]);
+        reports.push_back(report[0]);
+        pids.push_back(pid);
+    }
+    group.clear();
+
+    *seconds = 0.0;
+    *num_fluid = 0;
+    if(snapshots) snapshots->assign(num_subdomains, std::vector<char>());
+    int result = 0;
+    for(int rank = 0; rank < num_subdomains; rank++) {
+        std::vector<char> buf;
+        char chunk[4096];
+        ssize_t count;
+        while((count = read(reports[rank], chunk, sizeof(chunk))) > 0) buf.insert(buf.end(), chunk, chunk + count);
+        close(reports[rank]);
+
+        int status;
+        waitpid(pids[rank], &status, 0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || buf.size() < sizeof(double) + sizeof(int)) {
+            result = 1;
+            continue;
+        }
+        size_t offset = 0;
+        *seconds = glm::max(*seconds, Unpack<double>(buf, &offset));
+        *num_fluid += Unpack<int>(buf, &offset);
+        if(snapshots) snapshots->at(rank).assign(buf.begin() + offset, buf.end());
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+/**
+ * @file ensemble.cpp
+ * @brief Implementation of ensemble runner
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "ensemble.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] scenario scenario with ensemble size and ranges of variation
+ */
+Ensemble::Ensemble(const Scenario &scenario)
+: num_workers_(0), seconds_(0.0) {
+    Sample(scenario);
+}
+
+/**
+ * @brief destructor
+ */
+Ensemble::~Ensemble() {
+
+}
+
+/**
+ * @brief run all members, workers take the costliest remaining member first
+ * @param[in] num_steps number of steps of each member
+ * @param[in] num_workers number of concurrent simulaters, 0 for number of cores
+ */
+void Ensemble::Run(int num_steps, int num_workers) {
+    int num_cores = glm::max(std::thread::hardware_concurrency(), 1u);
+    num_workers_ = glm::clamp(num_workers > 0 ? num_workers : num_cores, 1, glm::max(GetNumMembers(), 1));
+
+    // longest processing time first keeps workers busy until the end
+    std::vector<int> order(GetNumMembers());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return EstimateCost(members_[a]) > EstimateCost(members_[b]);
+    });
+
+    // members differ only in fluid, so wall tables and terrain of an empty domain serve all of them
+    Scenario domain = members_.empty() ? Scenario() : members_[0];
+    domain.regions.clear();
+    SharedData<float> shared = Simulater<float>(domain).GetSharedData();
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int> next(0);
+    auto worker = [&](int w) {
+        for(int k = next++; k < order.size(); k = next++) RunMember(order[k], num_steps, w, shared);
+    };
+    std::vector<std::thread> threads;
+    for(int w = 1; w < num_workers_; w++) threads.emplace_back(worker, w);
+    worker(0);
+    for(std::thread &thread: threads) thread.join();
+    auto end = std::chrono::steady_clock::now();
+    seconds_ = std::chrono::duration<double>(end - start).count();
+}
+
+/**
+ * @brief write results of members as CSV
+ * @param[in] path file
+ * @return succeeded or not
+ */
+bool Ensemble::Write(const std::string &path) const {
+    std::ofstream file(path);
+    if(!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    file << "member,inflow_x,inflow_z,visc_scale,particles,steps,seconds,max_height,energy,finite,worker" << std::endl;
+    for(int m = 0; m < results_.size(); m++) {
+        const MemberResult &result = results_[m];
+        file << m << "," << result.inflow[0] << "," << result.inflow[1] << "," << result.visc_scale << ","
+             << result.num_particles << "," << result.num_steps << "," << result.seconds << ","
+             << result.max_height << "," << result.energy << "," << result.finite << "," << result.worker << std::endl;
+    }
+    return true;
+}
+
+/**
+ * @brief get number of members
+ * @return number of members
+ */
+int Ensemble::GetNumMembers() const {
+    return members_.size();
+}
+
+/**
+ * @brief get number of workers of last run
+ * @return number of workers
+ */
+int Ensemble::GetNumWorkers() const {
+    return num_workers_;
+}
+
+/**
+ * @brief get elapsed seconds of last run
+ * @return seconds
+ */
+double Ensemble::GetSeconds() const {
+    return seconds_;
+}
+
+/**
+ * @brief get results of members
+ * @return results in order of members
+ */
+const std::vector<MemberResult> &Ensemble::GetResults() const {
+    return results_;
+}
+
+/**
+ * @brief draw members by Latin hypercube sampling of ranges of variation
+ * @param[in] scenario scenario
+ */
+void Ensemble::Sample(const Scenario &scenario) {
+    int n = scenario.num_members;
+    members_.assign(n, scenario);
+    results_.assign(n, MemberResult());
+
+    // each parameter visits every one of n strata exactly once
+    std::mt19937 rng(scenario.ensemble_seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    auto stratified = [&](float lo, float hi) {
+        std::vector<int> strata(n);
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+        std::vector<float> values(n);
+        for(int m = 0; m < n; m++) values[m] = lo + (hi - lo) * (strata[m] + uniform(rng)) / n;
+        return values;
+    };
+    std::vector<float> inflow_x = stratified(scenario.min_inflow[0], scenario.max_inflow[0]);
+    std::vector<float> inflow_z = stratified(scenario.min_inflow[1], scenario.max_inflow[1]);
+    std::vector<float> visc_scale = stratified(scenario.visc_scale[0], scenario.visc_scale[1]);
+
+    for(int m = 0; m < n; m++) {
+        Scenario &member = members_[m];
+        member.num_members = 0;
+        // members would overwrite each other's logs
+        member.gauges.clear();
+
+        glm::vec2 inflow = glm::vec2(inflow_x[m], inflow_z[m]);
+        for(FluidRegion &region: member.regions) {
+            if(scenario.vary_inflow) region.vel = inflow;
+        }
+        for(int k = 1; k < member.phases.size(); k++) member.phases[k].visc *= visc_scale[m];
+
+        results_[m].inflow = scenario.vary_inflow ? inflow : member.regions.empty() ? glm::vec2(0.0f) : member.regions[0].vel;
+        results_[m].visc_scale = visc_scale[m];
+    }
+}
+
+/**
+ * @brief run member and record its outcome
+ * @param[in] m member
+ * @param[in] num_steps number of steps
+ * @param[in] worker worker running member
+ * @param[in] shared wall tables and terrain shared by members
+ */
+void Ensemble::RunMember(int m, int num_steps, int worker, const SharedData<float> &shared) {
+    Simulater<float> simulater(members_[m], shared);
+    int num_cores = glm::max(std::thread::hardware_concurrency(), 1u);
+    simulater.SetMaxThreads(glm::max(num_cores / num_workers_, 1));
+
+    MemberResult &result = results_[m];
+    result.num_particles = simulater.GetNumParticles(kFluid);
+    result.num_steps = num_steps;
+    result.max_height = -std::numeric_limits<float>::max();
+    result.worker = worker;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int step = 0; step < num_steps; step++) {
+        simulater.Evolve();
+        const std::vector<float> &height = simulater.GetHeights();
+        const std::vector<ParticleAttribute> &attr = simulater.GetAttributes();
+        for(int i = 0; i < height.size(); i++) {
+            if(attr[i] == kFluid) result.max_height = glm::max(result.max_height, height[i]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.energy = simulater.GetEnergy();
+    result.finite = std::isfinite(result.energy) && std::isfinite(result.max_height);
+}
+
+/**
+ * @brief estimate cost of member from area filled with fluid, which sets number of particles
+ * @param[in] member member
+ * @return area
+ */
+double Ensemble::EstimateCost(const Scenario &member) const {
+    double area = 0.0;
+    for(const FluidRegion &region: member.regions) {
+        glm::vec2 size = glm::max(region.max_coord - region.min_coord, glm::vec2(0.0f));
+        area += size[0] * size[1];
+    }
+    return area * member.scale * member.scale;
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+ * @file gauge.cpp
+ * @brief Implementation of virtual wave gauges
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "gauge.hpp"
+
+static const int kGaugeMagic = 0x47554147;
+static const int kGaugeVersion = 1;
+
+/**
+ * @brief constructor
+ * @param[in] points gauge positions
+ * @param[in] path log file
+ */
+Gauges::Gauges(const std::vector<glm::vec2> &points, const std::string &path)
+: points_(points), samples_(points.size()), path_(path), opened_(false) {
+    csv_ = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+}
+
+/**
+ * @brief destructor
+ */
+Gauges::~Gauges() {
+
+}
+
+/**
+ * @brief check log is open, or can still be opened when nothing was written yet
+ * @return open or not
+ */
+bool Gauges::IsOpen() const {
+    return !opened_ || (bool)file_;
+}
+
+/**
+ * @brief get number of gauges
+ * @return number of gauges
+ */
+int Gauges::GetNumGauges() const {
+    return points_.size();
+}
+
+/**
+ * @brief get gauge positions
+ * @return positions
+ */
+const std::vector<glm::vec2> &Gauges::GetPoints() const {
+    return points_;
+}
+
+/**
+ * @brief get path of log
+ * @return path
+ */
+const std::string &Gauges::GetPath() const {
+    return path_;
+}
+
+/**
+ * @brief set sample of gauge, gauges are independent so this may be called from several threads
+ * @param[in] gauge gauge index
+ * @param[in] sample sample
+ */
+void Gauges::SetSample(int gauge, const GaugeSample &sample) {
+    samples_[gauge] = sample;
+}
+
+/**
+ * @brief append samples of all gauges to log
+ * @param[in] time simulated time
+ */
+void Gauges::Write(double time) {
+    if(!opened_) Open();
+    if(!file_) return;
+    if(csv_) {
+        for(int g = 0; g < samples_.size(); g++) {
+            const GaugeSample &s = samples_[g];
+            file_ << time << "," << g << "," << s.depth << "," << s.height << "," << s.vel[0] << "," << s.vel[1] << "\n";
+        }
+        return;
+    }
+    // time followed by depth, height and velocity of each gauge
+    buf_.clear();
+    Pack(time, &buf_);
+    for(const GaugeSample &s: samples_) {
+        Pack(s.depth, &buf_);
+        Pack(s.height, &buf_);
+        Pack(s.vel, &buf_);
+    }
+    file_.write(buf_.data(), buf_.size());
+}
+
+/**
+ * @brief open log and write its header
+ */
+void Gauges::Open() {
+    opened_ = true;
+    file_.open(path_, csv_ ? std::ios::out : std::ios::out | std::ios::binary);
+    if(!file_) {
+        std::cerr << "Failed to open " << path_ << std::endl;
+        return;
+    }
+    WriteHeader();
+}
+
+/**
+ * @brief write gauge positions before samples
+ */
+void Gauges::WriteHeader() {
+    if(csv_) {
+        for(int g = 0; g < points_.size(); g++) {
+            file_ << "# gauge " << g << " " << points_[g][0] << " " << points_[g][1] << "\n";
+        }
+        file_ << "time,gauge,depth,height,vel_x,vel_z\n";
+        return;
+    }
+    buf_.clear();
+    Pack(kGaugeMagic, &buf_);
+    Pack(kGaugeVersion, &buf_);
+    Pack((int)points_.size(), &buf_);
+    for(const glm::vec2 &p: points_) Pack(p, &buf_);
+    file_.write(buf_.data(), buf_.size());
+}
\ No newline at end of file
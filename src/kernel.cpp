@@ -13,11 +13,12 @@
  * @param[in] h effective radius
  * @return scalar value
  */
-float Poly6(float r, float h) {
+template<typename T>
+T Poly6(T r, T h) {
     if(r < 0 || h < r) return 0;
-    float coef = 4.0f / (glm::pi<float>() * powf(h, 8.0f));
-    float tmp = powf(h, 2.0f) - powf(r, 2.0f);
-    float val = coef * (powf(tmp, 3.0f));
+    T coef = T(4) / (glm::pi<T>() * std::pow(h, T(8)));
+    T tmp = std::pow(h, T(2)) - std::pow(r, T(2));
+    T val = coef * (std::pow(tmp, T(3)));
     return val;
 }
 
@@ -28,11 +29,12 @@ float Poly6(float r, float h) {
  * @param[in] h effective radius
  * @return vector value
  */
-glm::vec2 GradPoly6(const glm::vec2 &r_ij, float r, float h) {
-    if(r < 0 || h < r) return glm::vec2(0.0f, 0.0f);
-    float coef = -24.0f / (glm::pi<float>() * powf(h, 8.0f));
-    float tmp = powf(h, 2.0f) - powf(r, 2.0f);
-    glm::vec2 val = coef * (powf(tmp, 2.0f) * r_ij);
+template<typename T>
+glm::vec<2, T> GradPoly6(const glm::vec<2, T> &r_ij, T r, T h) {
+    if(r < 0 || h < r) return glm::vec<2, T>(0);
+    T coef = -T(24) / (glm::pi<T>() * std::pow(h, T(8)));
+    T tmp = std::pow(h, T(2)) - std::pow(r, T(2));
+    glm::vec<2, T> val = coef * (std::pow(tmp, T(2)) * r_ij);
     return val;
 }
 
@@ -42,11 +44,12 @@ glm::vec2 GradPoly6(const glm::vec2 &r_ij, float r, float h) {
  * @param[in] h effective radius
  * @return scalar value
  */
-float LaplacePoly6(float r, float h) {
-    if(r < 0 || h < r) return 0.0f;
-    float coef = -24.0f / (glm::pi<float>() * powf(h, 8.0f));
-    float tmp = powf(h, 2.0f) - powf(r, 2.0f);
-    float val = coef * (3 * powf(tmp, 2.0f) - 4 * powf(r, 2.0f) * tmp);
+template<typename T>
+T LaplacePoly6(T r, T h) {
+    if(r < 0 || h < r) return 0;
+    T coef = -T(24) / (glm::pi<T>() * std::pow(h, T(8)));
+    T tmp = std::pow(h, T(2)) - std::pow(r, T(2));
+    T val = coef * (3 * std::pow(tmp, T(2)) - 4 * std::pow(r, T(2)) * tmp);
     return val;
 }
 
@@ -56,11 +59,12 @@ float LaplacePoly6(float r, float h) {
  * @param[in] h effective radius
  * @return scalar value
  */
-float Spiky(float r, float h) {
-    if(r < 0 || h < r) return 0.0f;
-    float coef = 10.0f / (glm::pi<float>() * powf(h, 5.0f));
-    float tmp = h - r;
-    float val = coef * (powf(tmp, 3.0f));
+template<typename T>
+T Spiky(T r, T h) {
+    if(r < 0 || h < r) return 0;
+    T coef = T(10) / (glm::pi<T>() * std::pow(h, T(5)));
+    T tmp = h - r;
+    T val = coef * (std::pow(tmp, T(3)));
     return val;
 }
 
@@ -71,11 +75,12 @@ float Spiky(float r, float h) {
  * @param[in] h effective radius
  * @return vector value
  */
-glm::vec2 GradSpiky(const glm::vec2 &r_ij, float r, float h) {
-    if(r < 0 || h < r) return glm::vec2(0.0f, 0.0f);
-    float coef = -30.0f / (glm::pi<float>() * powf(h, 5.0f));
-    float tmp = h - r;
-    glm::vec2 val = coef * (powf(tmp, 2.0f) * r_ij / r);
+template<typename T>
+glm::vec<2, T> GradSpiky(const glm::vec<2, T> &r_ij, T r, T h) {
+    if(r < 0 || h < r) return glm::vec<2, T>(0);
+    T coef = -T(30) / (glm::pi<T>() * std::pow(h, T(5)));
+    T tmp = h - r;
+    glm::vec<2, T> val = coef * (std::pow(tmp, T(2)) * r_ij / r);
     return val;
 }
 
@@ -85,11 +90,12 @@ glm::vec2 GradSpiky(const glm::vec2 &r_ij, float r, float h) {
  * @param[in] h effective radius
  * @return scalar value
  */
-float LaplaceSpiky(float r, float h) {
-    if(r < 0 || h < r) return 0.0f;
-    float coef = -60.0f / (glm::pi<float>() * powf(h, 5.0f));
-    float tmp = h - r;
-    float val = coef * (powf(tmp, 2.0f) / r - tmp);
+template<typename T>
+T LaplaceSpiky(T r, T h) {
+    if(r < 0 || h < r) return 0;
+    T coef = -T(60) / (glm::pi<T>() * std::pow(h, T(5)));
+    T tmp = h - r;
+    T val = coef * (std::pow(tmp, T(2)) / r - tmp);
     return val;
 }
 
@@ -99,10 +105,11 @@ float LaplaceSpiky(float r, float h) {
  * @param[in] h effective radius
  * @return scalar value
  */
-float Viscosity(float r, float h) {
-    if(r < 0 || h < r) return 0.0f;
-    float coef = 10.0f / (3 * glm::pi<float>() * powf(h, 2.0f));
-    float val = coef * (-powf(r, 3.0f) / (2 * powf(h, 3.0f)) + powf(r, 2.0f) / powf(h, 2.0f) + h / (2 * r) - 1);
+template<typename T>
+T Viscosity(T r, T h) {
+    if(r < 0 || h < r) return 0;
+    T coef = T(10) / (3 * glm::pi<T>() * std::pow(h, T(2)));
+    T val = coef * (-std::pow(r, T(3)) / (2 * std::pow(h, T(3))) + std::pow(r, T(2)) / std::pow(h, T(2)) + h / (2 * r) - 1);
     return val;
 }
 
@@ -113,10 +120,11 @@ float Viscosity(float r, float h) {
  * @param[in] h effective radius
  * @return vector value
  */
-glm::vec2 GradViscosity(const glm::vec2 &r_ij, float r, float h) {
-    if(r < 0 || h < r) return glm::vec2(0.0f, 0.0f);
-    float coef = 10.0f / (3 * glm::pi<float>() * powf(h, 4.0f));
-    glm::vec2 val = coef * ((-3 * r / (2 * h) + 2 - powf(h, 3.0f) / (2 * powf(r, 3.0f))) * r_ij);
+template<typename T>
+glm::vec<2, T> GradViscosity(const glm::vec<2, T> &r_ij, T r, T h) {
+    if(r < 0 || h < r) return glm::vec<2, T>(0);
+    T coef = T(10) / (3 * glm::pi<T>() * std::pow(h, T(4)));
+    glm::vec<2, T> val = coef * ((-3 * r / (2 * h) + 2 - std::pow(h, T(3)) / (2 * std::pow(r, T(3)))) * r_ij);
     return val;
 }
 
@@ -126,9 +134,32 @@ glm::vec2 GradViscosity(const glm::vec2 &r_ij, float r, float h) {
  * @param[in] h effective radius
  * @return scalar value
  */
-float LaplaceViscosity(float r, float h) {
-    if(r < 0 || h < r) return 0.0f;
-    float coef = 20.0f / (3 * glm::pi<float>() * powf(h, 5.0f));
-    float val = coef * (h - r);
+template<typename T>
+T LaplaceViscosity(T r, T h) {
+    if(r < 0 || h < r) return 0;
+    T coef = T(20) / (3 * glm::pi<T>() * std::pow(h, T(5)));
+    T val = coef * (h - r);
     return val;
-}
\ No newline at end of file
+}
+
+// explicit instantiation
+
+template float Poly6<float>(float r, float h);
+template glm::vec2 GradPoly6<float>(const glm::vec2 &r_ij, float r, float h);
+template float LaplacePoly6<float>(float r, float h);
+template float Spiky<float>(float r, float h);
+template glm::vec2 GradSpiky<float>(const glm::vec2 &r_ij, float r, float h);
+template float LaplaceSpiky<float>(float r, float h);
+template float Viscosity<float>(float r, float h);
+template glm::vec2 GradViscosity<float>(const glm::vec2 &r_ij, float r, float h);
+template float LaplaceViscosity<float>(float r, float h);
+
+template double Poly6<double>(double r, double h);
+template glm::dvec2 GradPoly6<double>(const glm::dvec2 &r_ij, double r, double h);
+template double LaplacePoly6<double>(double r, double h);
+template double Spiky<double>(double r, double h);
+template glm::dvec2 GradSpiky<double>(const glm::dvec2 &r_ij, double r, double h);
+template double LaplaceSpiky<double>(double r, double h);
+template double Viscosity<double>(double r, double h);
+template glm::dvec2 GradViscosity<double>(const glm::dvec2 &r_ij, double r, double h);
+template double LaplaceViscosity<double>(double r, double h);
\ No newline at end of file
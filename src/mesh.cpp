@@ -33,13 +33,39 @@ Mesh::~Mesh() {
  * @brief send vertex data to buffer
  */
 void Mesh::SendDataToBuffer() {
+    // positions followed by normals when mesh has them
+    int n = vertices_.size();
+    bool has_normals = normals_.size() == vertices_.size();
+    GLenum usage = has_normals ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
     glBindVertexArray(vao_);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertices_.size(), vertices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*n*(has_normals ? 2 : 1), NULL, usage);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec3)*n, vertices_.data());
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int)*indices_.size(), indices_.data(), GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
     glEnableVertexAttribArray(0);
+    if(has_normals) {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*n, sizeof(glm::vec3)*n, normals_.data());
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(sizeof(glm::vec3)*n));
+        glEnableVertexAttribArray(1);
+    }
+    glBindVertexArray(0);
+}
+
+/**
+ * @brief send range of vertex data to buffer allocated by SendDataToBuffer()
+ * @param[in] first first vertex
+ * @param[in] count number of vertices
+ */
+void Mesh::SendDataToBuffer(int first, int count) {
+    int n = vertices_.size();
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*first, sizeof(glm::vec3)*count, vertices_.data() + first);
+    if(normals_.size() == vertices_.size()) {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*(n + first), sizeof(glm::vec3)*count, normals_.data() + first);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 /**
@@ -7,6 +7,31 @@
 
 #include "nearest_neighbor.hpp"
 
+/**
+ * @brief insert a zero bit above every bit
+ * @param[in] v value
+ * @return spread value
+ */
+static uint64_t SpreadBits(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+/**
+ * @brief first slot of cell in hash table
+ * @param[in] hash Morton code of cell
+ * @param[in] mask table size minus one
+ * @return slot
+ */
+static int FirstSlot(uint64_t hash, int mask) {
+    return (int)((hash * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+}
+
 /**
  * @brief constructor
  * @param[in] min_cord minimum coordinate
@@ -14,35 +39,35 @@
  * @param[in] effective_radius effective radius
  * @param[in] num_particles number of particles
  */
-NearestNeighbor::NearestNeighbor(const glm::vec2 &min_cord, const glm::vec2 &max_cord, float effective_radius, int num_particles) 
-: origin_(min_cord) {
-    glm::vec2 world_size = max_cord - min_cord;
-    float max_width = glm::max(world_size[0], world_size[1]);
+template<typename T>
+NearestNeighbor<T>::NearestNeighbor(const glm::vec<2, T> &min_cord, const glm::vec<2, T> &max_cord, T effective_radius, int num_particles) 
+: origin_(min_cord), world_size_(max_cord - min_cord), periodic_(false), begin_(0), max_churn_(0.25), num_moved_(0) {
+    glm::vec<2, T> world_size = world_size_;
+    T max_width = glm::max(world_size[0], world_size[1]);
 
     // calculate cell width
-    float d = ceilf(logf(max_width / effective_radius) / logf(2.0f));
-    float m = ceilf(powf(2.0f, d));
-    float cell_width = max_width / m;
-    cell_width_ = glm::vec2(cell_width);
+    T d = std::ceil(std::log(max_width / effective_radius) / std::log(T(2)));
+    T m = std::ceil(std::pow(T(2), d));
+    T cell_width = max_width / m;
+    cell_width_ = glm::vec<2, T>(cell_width);
 
     // calculate number of cells
     for(int i = 0; i < 2; i++) {
-        d = ceilf(log(world_size[i] / cell_width) / logf(2.0f));
-        num_cells_[i] = (int)ceilf(powf(2.0f, d));
+        d = std::ceil(std::log(world_size[i] / cell_width) / std::log(T(2)));
+        num_cells_[i] = (int)std::ceil(std::pow(T(2), d));
     }
-    num_all_cells_ = num_cells_[0] * num_cells_[1];
 
-    // allocate memory
-    sorted_index_.resize(num_particles);
-    grid_hash_.resize(num_particles);
-    starts_.resize(num_all_cells_);
-    ends_.resize(num_all_cells_);
+    // allocate memory, cells are allocated only when occupied
+    sorted_index_.reserve(num_particles);
+    grid_hash_.reserve(num_particles);
+    BuildCells();
 }
 
 /**
  * @brief destructor
  */
-NearestNeighbor::~NearestNeighbor() {
+template<typename T>
+NearestNeighbor<T>::~NearestNeighbor() {
 
 }
 
@@ -50,51 +75,127 @@ NearestNeighbor::~NearestNeighbor() {
  * @brief register particles on cells
  * @param[in] ppos particles position
  */
-void NearestNeighbor::Register(const std::vector<glm::vec2> &ppos) {
-    // reset vectors
-    std::fill(sorted_index_.begin(), sorted_index_.end(), 0);
-    std::fill(grid_hash_.begin(), grid_hash_.end(), 0);
-    std::fill(starts_.begin(), starts_.end(), 0xffffffff);
-    std::fill(ends_.begin(), ends_.end(), 0xffffffff);
+template<typename T>
+void NearestNeighbor<T>::Register(const std::vector<glm::vec<2, T>> &ppos) {
+    Register(ppos, 0, ppos.size());
+}
+
+/**
+ * @brief register a range of particles on cells
+ * @param[in] ppos particles position
+ * @param[in] begin first particle index
+ * @param[in] end last particle index (exclusive)
+ */
+template<typename T>
+void NearestNeighbor<T>::Register(const std::vector<glm::vec<2, T>> &ppos, int begin, int end) {
+    int n = end - begin;
 
-    for(int i = 0; i < ppos.size(); i++) {
-        int hash = CalculateHash(ppos[i]);
-        sorted_index_[i] = i;
-        grid_hash_[i] = hash;
+    // same particles as last time, so only patch the ones which changed cells
+    if(n > 0 && n == grid_hash_.size() && begin == begin_ && Update(ppos)) return;
+    begin_ = begin;
+    num_moved_ = n;
+
+    scratch_.Reset();
+    std::pair<uint64_t, int> *hash_and_value = scratch_.Allocate<std::pair<uint64_t, int>>(n);
+    for(int i = 0; i < n; i++) {
+        hash_and_value[i].first = CalculateHash(ppos[begin+i]);
+        hash_and_value[i].second = begin+i;
     }
+    Sort(hash_and_value, n);
+}
+
+/**
+ * @brief register selected particles on cells
+ * @param[in] ppos particles position
+ * @param[in] indices particle indices
+ */
+template<typename T>
+void NearestNeighbor<T>::Register(const std::vector<glm::vec<2, T>> &ppos, const std::vector<int> &indices) {
+    int n = indices.size();
+
+    // no range to compare with next time, so always rebuild
+    begin_ = -1;
+    num_moved_ = n;
 
-    std::vector<std::pair<int, int>> hash_and_value;
-    hash_and_value.resize(ppos.size());
-    for(int i = 0; i < ppos.size(); i++) {
-        hash_and_value[i].first = grid_hash_[i];
-        hash_and_value[i].second = sorted_index_[i];
+    scratch_.Reset();
+    std::pair<uint64_t, int> *hash_and_value = scratch_.Allocate<std::pair<uint64_t, int>>(n);
+    for(int i = 0; i < n; i++) {
+        hash_and_value[i].first = CalculateHash(ppos[indices[i]]);
+        hash_and_value[i].second = indices[i];
     }
-    std::sort(hash_and_value.begin(), hash_and_value.end());
-    for(int i = 0; i < ppos.size(); i++) {
+    Sort(hash_and_value, n);
+}
+
+/**
+ * @brief sort particles by cell and build cells
+ * @param[in,out] hash_and_value hash and index of particles
+ * @param[in] n number of particles
+ */
+template<typename T>
+void NearestNeighbor<T>::Sort(std::pair<uint64_t, int> *hash_and_value, int n) {
+    std::sort(hash_and_value, hash_and_value + n);
+
+    sorted_index_.resize(n);
+    grid_hash_.resize(n);
+    for(int i = 0; i < n; i++) {
         sorted_index_[i] = hash_and_value[i].second;
         grid_hash_[i] = hash_and_value[i].first;
     }
 
-    for(int i = 0; i < ppos.size(); i++) {
-        int hash = grid_hash_[i];
+    BuildCells();
+}
+
+/**
+ * @brief move particles which changed cells, keeping the order of full rebuild
+ * @param[in] ppos particles position
+ * @return patched, or false if too many particles moved
+ */
+template<typename T>
+bool NearestNeighbor<T>::Update(const std::vector<glm::vec<2, T>> &ppos) {
+    int n = grid_hash_.size();
+    int max_moved = (int)(max_churn_ * n);
 
-        if(i == 0) {
-            starts_[hash] = i;
-            ends_[hash] = i;
-        } else {
-            int prev_hash = grid_hash_[i-1];
+    // particles staying in their cells remain sorted after compaction
+    scratch_.Reset();
+    std::pair<uint64_t, int> *moved = scratch_.Allocate<std::pair<uint64_t, int>>(max_moved + 1);
+    int *kept = scratch_.Allocate<int>(n);
+    int num_moved = 0;
+    int num_kept = 0;
+    for(int k = 0; k < n; k++) {
+        int idx = sorted_index_[k];
+        uint64_t hash = CalculateHash(ppos[idx]);
+        if(hash == grid_hash_[k]) {
+            kept[num_kept++] = k;
+            continue;
+        }
+        moved[num_moved++] = std::make_pair(hash, idx);
+        if(num_moved > max_moved) return false;
+    }
+    num_moved_ = num_moved;
+    if(num_moved == 0) return true;
+    std::sort(moved, moved + num_moved);
 
-            if(i == 0 || hash != prev_hash) {
-                starts_[hash] = i;
-                if(i > 0) {
-                    ends_[prev_hash] = i;
-                }
-            }
-            if(i == ppos.size()-1) {
-                ends_[hash] = i+1;
-            }
+    int *sorted_index = scratch_.Allocate<int>(n);
+    uint64_t *grid_hash = scratch_.Allocate<uint64_t>(n);
+    int a = 0;
+    int b = 0;
+    for(int k = 0; k < n; k++) {
+        bool take_kept = b == num_moved || (a < num_kept && std::make_pair(grid_hash_[kept[a]], sorted_index_[kept[a]]) < moved[b]);
+        if(take_kept) {
+            grid_hash[k] = grid_hash_[kept[a]];
+            sorted_index[k] = sorted_index_[kept[a]];
+            a++;
+        } else {
+            grid_hash[k] = moved[b].first;
+            sorted_index[k] = moved[b].second;
+            b++;
         }
     }
+    std::copy(sorted_index, sorted_index + n, sorted_index_.begin());
+    std::copy(grid_hash, grid_hash + n, grid_hash_.begin());
+
+    BuildCells();
+    return true;
 }
 
 /**
@@ -103,7 +204,8 @@ void NearestNeighbor::Register(const std::vector<glm::vec2> &ppos) {
  * @param[out] neighbors neighbor particles
  * @param[in] radius search radius
  */
-void NearestNeighbor::Search(const std::vector<glm::vec2> &ppos, std::vector<std::vector<int>> *neighbors, float radius) {
+template<typename T>
+void NearestNeighbor<T>::Search(const std::vector<glm::vec<2, T>> &ppos, std::vector<std::vector<int>> *neighbors, T radius) {
     for(int i = 0; i < (int)ppos.size(); i++) {
         neighbors->at(i).clear();
         Search(ppos[i], ppos, &neighbors->at(i), radius);
@@ -117,30 +219,278 @@ void NearestNeighbor::Search(const std::vector<glm::vec2> &ppos, std::vector<std
  * @param[out] neighbors neighbor particles
  * @param[in] radius search radius
  */
-void NearestNeighbor::Search(const glm::vec2 &pos, const std::vector<glm::vec2> &ppos, std::vector<int> *neighbors, float radius) {
-    glm::ivec2 index = CalculateIndex(pos);
-    glm::ivec2 range = glm::ivec2(radius / cell_width_) + 1;
-    for(int j = -range[1]; j <= range[1]; j++) {
-        for(int i = -range[0]; i <= range[0]; i++) {
-            glm::ivec2 neighbor_cell_index = index + glm::ivec2(i, j);
-            if(neighbor_cell_index[0] < 0 || num_cells_[0] <= neighbor_cell_index[0] || neighbor_cell_index[1] < 0 || num_cells_[1] <= neighbor_cell_index[1]) {
-                continue;;
+template<typename T>
+void NearestNeighbor<T>::Search(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &ppos, std::vector<int> *neighbors, T radius) {
+    if(num_occupied_cells_ == 0) return;
+    // only cells overlapping bounding box of search circle
+    glm::ivec2 min_index = CalculateIndex(pos - radius);
+    glm::ivec2 max_index = CalculateIndex(pos + radius);
+    bool wraps = false;
+    for(int a = 0; a < 2; a++) {
+        wraps = wraps || (periodic_[a] && (min_index[a] < 0 || max_index[a] >= num_cells_[a]));
+    }
+    if(!wraps) {
+        for(int j = min_index[1]; j <= max_index[1]; j++) {
+            for(int i = min_index[0]; i <= max_index[0]; i++) {
+                SearchNeighborsInCell(pos, ppos, glm::ivec2(i, j), neighbors, radius);
+            }
+        }
+        return;
+    }
+
+    // cells beyond the period are images of cells inside, searched with position shifted back
+    for(int a = 0; a < 2; a++) {
+        if(periodic_[a]) max_index[a] = glm::min(max_index[a], min_index[a] + num_cells_[a] - 1);
+    }
+    for(int j = min_index[1]; j <= max_index[1]; j++) {
+        for(int i = min_index[0]; i <= max_index[0]; i++) {
+            glm::vec<2, T> shift;
+            glm::ivec2 index = WrapIndex(glm::ivec2(i, j), &shift);
+            SearchNeighborsInCell(pos - shift, ppos, index, neighbors, radius);
+        }
+    }
+}
+
+/**
+ * @brief count particles tested by search without testing them
+ * @param[in] pos search position
+ * @param[in] radius search radius
+ * @param[out] num_cells number of cells visited
+ * @return number of candidates
+ */
+template<typename T>
+int NearestNeighbor<T>::CountCandidates(const glm::vec<2, T> &pos, T radius, int *num_cells) const {
+    glm::ivec2 min_index = CalculateIndex(pos - radius);
+    glm::ivec2 max_index = CalculateIndex(pos + radius);
+    for(int a = 0; a < 2; a++) {
+        if(periodic_[a]) max_index[a] = glm::min(max_index[a], min_index[a] + num_cells_[a] - 1);
+    }
+    *num_cells = (max_index[0] - min_index[0] + 1) * (max_index[1] - min_index[1] + 1);
+    if(num_occupied_cells_ == 0) return 0;
+    int num_candidates = 0;
+    for(int j = min_index[1]; j <= max_index[1]; j++) {
+        for(int i = min_index[0]; i <= max_index[0]; i++) {
+            glm::vec<2, T> shift;
+            const GridCell *cell = FindCell(CalculateHash(WrapIndex(glm::ivec2(i, j), &shift)));
+            if(cell != nullptr) num_candidates += cell->end - cell->start;
+        }
+    }
+    return num_candidates;
+}
+
+/**
+ * @brief count particles within radius without collecting them
+ * @param[in] pos search position
+ * @param[in] ppos particles position
+ * @param[in] radius search radius
+ * @return number of particles
+ */
+template<typename T>
+int NearestNeighbor<T>::Count(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &ppos, T radius) const {
+    if(num_occupied_cells_ == 0) return 0;
+    glm::ivec2 min_index = CalculateIndex(pos - radius);
+    glm::ivec2 max_index = CalculateIndex(pos + radius);
+    for(int a = 0; a < 2; a++) {
+        if(periodic_[a]) max_index[a] = glm::min(max_index[a], min_index[a] + num_cells_[a] - 1);
+    }
+    int count = 0;
+    for(int j = min_index[1]; j <= max_index[1]; j++) {
+        for(int i = min_index[0]; i <= max_index[0]; i++) {
+            glm::vec<2, T> shift;
+            const GridCell *cell = FindCell(CalculateHash(WrapIndex(glm::ivec2(i, j), &shift)));
+            if(cell == nullptr) continue;
+            for(int k = cell->start; k < cell->end; k++) {
+                if(glm::length2(pos - shift - ppos[sorted_index_[k]]) <= radius * radius) count++;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief change cell width, particles have to be registered again
+ * @param[in] cell_width cell width
+ */
+template<typename T>
+void NearestNeighbor<T>::SetCellWidth(T cell_width) {
+    cell_width_ = glm::vec<2, T>(cell_width);
+    num_cells_ = glm::ivec2(glm::ceil(world_size_ / cell_width));
+    for(int a = 0; a < 2; a++) {
+        if(!periodic_[a]) continue;
+        num_cells_[a] = glm::max((int)std::floor(world_size_[a] / cell_width), 1);
+        cell_width_[a] = world_size_[a] / num_cells_[a];
+    }
+
+    // nothing to patch, so next registration is a full rebuild
+    sorted_index_.clear();
+    grid_hash_.clear();
+    BuildCells();
+}
+
+/**
+ * @brief wrap axes around domain, particles have to be registered again
+ * @details period has to be longer than twice the search radius, so that a particle has one image in range
+ * @param[in] periodic periodic axes
+ * @param[in] min_coord minimum coordinate of period
+ * @param[in] max_coord maximum coordinate of period
+ * @param[in] radius largest search radius
+ */
+template<typename T>
+void NearestNeighbor<T>::SetPeriodic(const glm::bvec2 &periodic, const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord, T radius) {
+    periodic_ = periodic;
+    for(int a = 0; a < 2; a++) {
+        if(!periodic_[a]) continue;
+        origin_[a] = min_coord[a];
+        world_size_[a] = max_coord[a] - min_coord[a];
+        assert(world_size_[a] >= 2 * radius);
+    }
+    SetCellWidth(cell_width_[0]);
+}
+
+/**
+ * @brief shortest of displacements between images along periodic axes
+ * @param[in] r displacement
+ * @return displacement to nearest image
+ */
+template<typename T>
+glm::vec<2, T> NearestNeighbor<T>::MinimumImage(const glm::vec<2, T> &r) const {
+    return ::MinimumImage(r, periodic_, world_size_);
+}
+
+/**
+ * @brief time searches of particles with cell widths relative to radius and keep the fastest
+ * @param[in] ppos particles position
+ * @param[in] begin first particle index
+ * @param[in] end last particle index (exclusive)
+ * @param[in] radius search radius
+ * @param[in] ratios cell widths over radius to try, after current width
+ * @param[out] trials cost of each width
+ * @return chosen cell width
+ */
+template<typename T>
+T NearestNeighbor<T>::Tune(const std::vector<glm::vec<2, T>> &ppos, int begin, int end, T radius, const std::vector<T> &ratios, std::vector<GridTrial> *trials) {
+    std::vector<T> widths = {cell_width_[0]};
+    for(T ratio: ratios) widths.push_back(ratio * radius);
+
+    int num_reps = 3;
+    T best_width = cell_width_[0];
+    double best_seconds = std::numeric_limits<double>::max();
+    std::vector<int> neighbors;
+    trials->clear();
+    for(T width: widths) {
+        SetCellWidth(width);
+        Register(ppos, begin, end);
+
+        // fastest of repetitions, as single core timings are noisy
+        double seconds = std::numeric_limits<double>::max();
+        for(int rep = 0; rep < num_reps; rep++) {
+            auto start = std::chrono::steady_clock::now();
+            for(int i = begin; i < end; i++) {
+                neighbors.clear();
+                Search(ppos[i], ppos, &neighbors, radius);
             }
-            SearchNeighborsInCell(pos, ppos, neighbor_cell_index, neighbors, radius);
+            auto stop = std::chrono::steady_clock::now();
+            seconds = glm::min(seconds, std::chrono::duration<double>(stop - start).count());
+        }
+
+        long long num_cells = 0;
+        long long num_candidates = 0;
+        long long num_hits = 0;
+        for(int i = begin; i < end; i++) {
+            int cells;
+            num_candidates += CountCandidates(ppos[i], radius, &cells);
+            num_cells += cells;
+            neighbors.clear();
+            Search(ppos[i], ppos, &neighbors, radius);
+            num_hits += neighbors.size();
+        }
+        int n = glm::max(end - begin, 1);
+        trials->push_back(GridTrial{(double)width, seconds, (double)num_cells / n, (double)num_candidates / glm::max(num_hits, 1LL)});
+        if(seconds < best_seconds) {
+            best_seconds = seconds;
+            best_width = width;
         }
     }
+    SetCellWidth(best_width);
+    return best_width;
+}
+
+/**
+ * @brief get number of particles which changed cells at last registration
+ * @return number of particles, all of them for full rebuild
+ */
+template<typename T>
+int NearestNeighbor<T>::GetNumMoved() const {
+    return num_moved_;
+}
+
+/**
+ * @brief get origin of grid
+ * @return origin
+ */
+template<typename T>
+glm::vec<2, T> NearestNeighbor<T>::GetOrigin() const {
+    return origin_;
+}
+
+/**
+ * @brief get cell width
+ * @return cell width
+ */
+template<typename T>
+glm::vec<2, T> NearestNeighbor<T>::GetCellWidth() const {
+    return cell_width_;
+}
+
+/**
+ * @brief get number of cells
+ * @return number of cells
+ */
+template<typename T>
+glm::ivec2 NearestNeighbor<T>::GetNumCells() const {
+    return num_cells_;
+}
+
+/**
+ * @brief get number of occupied cells
+ * @return number of cells
+ */
+template<typename T>
+int NearestNeighbor<T>::GetNumOccupiedCells() const {
+    return num_occupied_cells_;
+}
+
+/**
+ * @brief get key of cell containing position, close cells have close keys
+ * @param[in] pos position
+ * @return Morton code of cell
+ */
+template<typename T>
+uint64_t NearestNeighbor<T>::GetCellHash(const glm::vec<2, T> &pos) const {
+    return CalculateHash(pos);
+}
+
+/**
+ * @brief get memory held by grid
+ * @return bytes
+ */
+template<typename T>
+size_t NearestNeighbor<T>::GetMemoryUsage() const {
+    return sorted_index_.capacity() * sizeof(int) + grid_hash_.capacity() * sizeof(uint64_t) + cells_.capacity() * sizeof(GridCell) + scratch_.GetCapacity();
 }
 
 /**
  * @brief check parameters
  */
-void NearestNeighbor::CheckParameters() const {
+template<typename T>
+void NearestNeighbor<T>::CheckParameters() const {
     std::cout << std::endl;
     std::cout << "NearestNeighbor:" << std::endl;
     std::cout << "origin_: "     << "( " << origin_[0]     << ", " << origin_[1]     << " )" << std::endl;
     std::cout << "cell_width_: " << "( " << cell_width_[0] << ", " << cell_width_[1] << " )" << std::endl;
     std::cout << "num_cells_: "  << "( " << num_cells_[0]  << ", " << num_cells_[1]  << " )" << std::endl;
-    std::cout << "num_all_cells_: " << num_all_cells_ << std::endl;
+    std::cout << "periodic_: "   << "( " << periodic_[0]   << ", " << periodic_[1]   << " )" << std::endl;
+    std::cout << "num_occupied_cells_: " << num_occupied_cells_ << std::endl;
 }
 
 /**
@@ -151,50 +501,278 @@ void NearestNeighbor::CheckParameters() const {
  * @param[out] neighbors neighbor particles
  * @param[in] radius search radius
  */
-void NearestNeighbor::SearchNeighborsInCell(const glm::vec2 &pos, const std::vector<glm::vec2> &ppos, const glm::ivec2 index, std::vector<int> *neighbors, float radius) {
-    int hash = CalculateHash(index);
-    int start_index = starts_[hash];
-    int end_index = ends_[hash];
-    if(start_index == 0xffffffff) return;
+template<typename T>
+void NearestNeighbor<T>::SearchNeighborsInCell(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &ppos, const glm::ivec2 index, std::vector<int> *neighbors, T radius) {
+    const GridCell *cell = FindCell(CalculateHash(index));
+    if(cell == nullptr) return;
 
-    for(int j = start_index; j < end_index; j++) {
+    for(int j = cell->start; j < cell->end; j++) {
         int idx = sorted_index_[j];
-        glm::vec2 r_ij = pos - ppos[idx];
+        glm::vec<2, T> r_ij = pos - ppos[idx];
         if(glm::length2(r_ij) <= radius * radius) {
             neighbors->push_back(idx);
         }
     }
 }
 
+/**
+ * @brief collect occupied cells from sorted particles into hash table
+ */
+template<typename T>
+void NearestNeighbor<T>::BuildCells() {
+    int n = grid_hash_.size();
+    num_occupied_cells_ = 0;
+    for(int i = 0; i < n; i++) {
+        if(i == 0 || grid_hash_[i] != grid_hash_[i-1]) num_occupied_cells_++;
+    }
+
+    // load factor at most one half
+    int capacity = 16;
+    while(capacity < 2 * num_occupied_cells_) capacity *= 2;
+    cells_.assign(capacity, GridCell{0, -1, -1});
+    int mask = capacity - 1;
+    GridCell *cell = nullptr;
+    for(int i = 0; i < n; i++) {
+        if(i == 0 || grid_hash_[i] != grid_hash_[i-1]) {
+            int slot = FirstSlot(grid_hash_[i], mask);
+            while(cells_[slot].start >= 0) slot = (slot + 1) & mask;
+            cell = &cells_[slot];
+            cell->hash = grid_hash_[i];
+            cell->start = i;
+        }
+        cell->end = i+1;
+    }
+}
+
+/**
+ * @brief find occupied cell
+ * @param[in] hash Morton code of cell
+ * @return cell, or nullptr if empty
+ */
+template<typename T>
+const GridCell *NearestNeighbor<T>::FindCell(uint64_t hash) const {
+    int mask = cells_.size() - 1;
+    for(int slot = FirstSlot(hash, mask); ; slot = (slot + 1) & mask) {
+        const GridCell &cell = cells_[slot];
+        if(cell.start < 0) return nullptr;
+        if(cell.hash == hash) return &cell;
+    }
+}
+
 /**
  * @brief calculate index
  * @param[in] pos position
  * @return index
  */
-glm::ivec2 NearestNeighbor::CalculateIndex(const glm::vec2 &pos) const {
-    glm::vec2 p = pos - origin_;
-    glm::ivec2 index = glm::ivec2(p / cell_width_);
-    index = glm::clamp(index, glm::ivec2(0, 0), num_cells_ - 1);
+template<typename T>
+glm::ivec2 NearestNeighbor<T>::CalculateIndex(const glm::vec<2, T> &pos) const {
+    glm::vec<2, T> p = pos - origin_;
+    glm::ivec2 index = glm::ivec2(glm::floor(p / cell_width_));
     return index;
 }
 
+/**
+ * @brief wrap index into period along periodic axes
+ * @param[in] index index
+ * @param[out] shift offset of image cell from wrapped cell
+ * @return wrapped index
+ */
+template<typename T>
+glm::ivec2 NearestNeighbor<T>::WrapIndex(const glm::ivec2 &index, glm::vec<2, T> *shift) const {
+    glm::ivec2 wrapped = index;
+    *shift = glm::vec<2, T>(0);
+    for(int a = 0; a < 2; a++) {
+        if(!periodic_[a]) continue;
+        wrapped[a] = ((index[a] % num_cells_[a]) + num_cells_[a]) % num_cells_[a];
+        (*shift)[a] = (index[a] - wrapped[a]) / num_cells_[a] * world_size_[a];
+    }
+    return wrapped;
+}
+
 /**
  * @brief calculate hash
  * @param[in] pos position
  * @return hash value
  */
-int NearestNeighbor::CalculateHash(const glm::vec2 &pos) const {
+template<typename T>
+uint64_t NearestNeighbor<T>::CalculateHash(const glm::vec<2, T> &pos) const {
     glm::ivec2 index = CalculateIndex(pos);
-    int hash = CalculateHash(index);
+    if(periodic_[0] || periodic_[1]) {
+        glm::vec<2, T> shift;
+        index = WrapIndex(index, &shift);
+    }
+    uint64_t hash = CalculateHash(index);
     return hash;
 }
 
 /**
- * @brief calculate hash
- * @param[in] index index
+ * @brief calculate Morton code of cell
+ * @param[in] index index, cells outside domain are allowed
  * @return hash value
  */
-int NearestNeighbor::CalculateHash(const glm::ivec2 &index) const {
-    int hash = index[1] * num_cells_[0] + index[0];
+template<typename T>
+uint64_t NearestNeighbor<T>::CalculateHash(const glm::ivec2 &index) const {
+    // flip sign bit so that negative indices keep their order
+    uint32_t x = (uint32_t)index[0] ^ 0x80000000u;
+    uint32_t z = (uint32_t)index[1] ^ 0x80000000u;
+    uint64_t hash = SpreadBits(x) | (SpreadBits(z) << 1);
     return hash;
 }
+
+/**
+ * @brief constructor
+ * @param[in] min_cord minimum coordinate
+ * @param[in] max_cord maximum coordinate
+ * @param[in] min_radius radius covered by finest level
+ * @param[in] num_levels number of levels, each doubling radius
+ * @param[in] num_particles number of particles
+ */
+template<typename T>
+MultiLevelNeighbor<T>::MultiLevelNeighbor(const glm::vec<2, T> &min_cord, const glm::vec<2, T> &max_cord, T min_radius, int num_levels, int num_particles)
+: min_radius_(min_radius), radii_(nullptr) {
+    for(int l = 0; l < num_levels; l++) {
+        levels_.push_back(std::make_unique<NearestNeighbor<T>>(min_cord, max_cord, min_radius * (1 << l), num_particles));
+    }
+    indices_.resize(num_levels);
+    max_radii_.resize(num_levels, 0);
+}
+
+/**
+ * @brief destructor
+ */
+template<typename T>
+MultiLevelNeighbor<T>::~MultiLevelNeighbor() {
+
+}
+
+/**
+ * @brief register a range of particles on level matching their radii
+ * @param[in] ppos particles position
+ * @param[in] radii particles radius
+ * @param[in] begin first particle index
+ * @param[in] end last particle index (exclusive)
+ */
+template<typename T>
+void MultiLevelNeighbor<T>::Register(const std::vector<glm::vec<2, T>> &ppos, const std::vector<T> &radii, int begin, int end) {
+    radii_ = &radii;
+    for(int l = 0; l < levels_.size(); l++) {
+        // any level may take all particles, so lists never grow unless count grows by half
+        indices_[l].clear();
+        if(indices_[l].capacity() < end - begin) indices_[l].reserve((end - begin) * 3 / 2);
+        max_radii_[l] = 0;
+    }
+    for(int i = begin; i < end; i++) {
+        int l = GetLevel(radii[i]);
+        indices_[l].push_back(i);
+        max_radii_[l] = glm::max(max_radii_[l], radii[i]);
+    }
+    for(int l = 0; l < levels_.size(); l++) {
+        levels_[l]->Register(ppos, indices_[l]);
+    }
+}
+
+/**
+ * @brief search particles j closer than mean of radius and radius of j
+ * @param[in] pos search position
+ * @param[in] radius radius of searching particle
+ * @param[in] ppos particles position
+ * @param[out] neighbors neighbor particles
+ */
+template<typename T>
+void MultiLevelNeighbor<T>::Search(const glm::vec<2, T> &pos, T radius, const std::vector<glm::vec<2, T>> &ppos, std::vector<int> *neighbors) {
+    for(int l = 0; l < levels_.size(); l++) {
+        if(indices_[l].empty()) continue;
+
+        // candidates within the widest pair radius of this level, then exact pair radius
+        int first = neighbors->size();
+        levels_[l]->Search(pos, ppos, neighbors, (radius + max_radii_[l]) / 2);
+        int n = first;
+        for(int k = first; k < neighbors->size(); k++) {
+            int j = neighbors->at(k);
+            T h = (radius + radii_->at(j)) / 2;
+            if(glm::length2(levels_[l]->MinimumImage(pos - ppos[j])) <= h * h) neighbors->at(n++) = j;
+        }
+        neighbors->resize(n);
+    }
+}
+
+/**
+ * @brief count particles of all levels within radius, whatever their own radii
+ * @param[in] pos search position
+ * @param[in] radius search radius
+ * @param[in] ppos particles position
+ * @return number of particles
+ */
+template<typename T>
+int MultiLevelNeighbor<T>::Count(const glm::vec<2, T> &pos, T radius, const std::vector<glm::vec<2, T>> &ppos) const {
+    int count = 0;
+    for(int l = 0; l < levels_.size(); l++) {
+        if(!indices_[l].empty()) count += levels_[l]->Count(pos, ppos, radius);
+    }
+    return count;
+}
+
+/**
+ * @brief wrap axes of all levels around domain
+ * @param[in] periodic periodic axes
+ * @param[in] min_coord minimum coordinate of period
+ * @param[in] max_coord maximum coordinate of period
+ */
+template<typename T>
+void MultiLevelNeighbor<T>::SetPeriodic(const glm::bvec2 &periodic, const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord) {
+    for(int l = 0; l < levels_.size(); l++) {
+        levels_[l]->SetPeriodic(periodic, min_coord, max_coord, min_radius_ * (1 << l));
+    }
+}
+
+/**
+ * @brief get level whose cells cover radius
+ * @param[in] radius radius
+ * @return level
+ */
+template<typename T>
+int MultiLevelNeighbor<T>::GetLevel(T radius) const {
+    int l = 0;
+    while(l < (int)levels_.size() - 1 && radius > min_radius_ * (1 << l)) l++;
+    return l;
+}
+
+/**
+ * @brief get number of levels
+ * @return number of levels
+ */
+template<typename T>
+int MultiLevelNeighbor<T>::GetNumLevels() const {
+    return levels_.size();
+}
+
+/**
+ * @brief get grid of level
+ * @param[in] level level
+ * @return grid
+ */
+template<typename T>
+const NearestNeighbor<T> &MultiLevelNeighbor<T>::GetGrid(int level) const {
+    return *levels_[level];
+}
+
+/**
+ * @brief get memory held by grids of all levels
+ * @return bytes
+ */
+template<typename T>
+size_t MultiLevelNeighbor<T>::GetMemoryUsage() const {
+    size_t bytes = 0;
+    for(int l = 0; l < levels_.size(); l++) {
+        bytes += levels_[l]->GetMemoryUsage();
+        bytes += indices_[l].capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
+// explicit instantiation
+
+template class NearestNeighbor<float>;
+template class NearestNeighbor<double>;
+template class MultiLevelNeighbor<float>;
+template class MultiLevelNeighbor<double>;
\ No newline at end of file
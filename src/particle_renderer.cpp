@@ -0,0 +1,268 @@
+/**
+ * @file particle_renderer.cpp
+ * @brief Implementation of particle renderer
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "particle_renderer.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] min_coord minimum coordinate of particles
+ * @param[in] max_coord maximum coordinate of particles
+ * @param[in] num_cells number of cells along each axis
+ */
+ParticleRenderer::ParticleRenderer(const glm::vec2 &min_coord, const glm::vec2 &max_coord, int num_cells)
+: min_coord_(min_coord), num_cells_(num_cells), culling_(true), lod_distance_(8.0f), num_visible_cells_(0), num_drawn_(0), vao_(0), vbo_(0), buffer_size_(0), buffer_updated_(false) {
+    cell_width_ = (max_coord - min_coord) / glm::vec2(num_cells_);
+    cell_start_.resize(GetNumCells() + 1, 0);
+    cell_cursor_.resize(GetNumCells());
+    cell_height_.resize(GetNumCells());
+}
+
+/**
+ * @brief destructor
+ */
+ParticleRenderer::~ParticleRenderer() {
+    if(vao_ == 0) return;
+    glDeleteBuffers(1, &vbo_);
+    glDeleteVertexArrays(1, &vao_);
+}
+
+/**
+ * @brief sort particles into cells by counting and track height range of cells
+ * @param[in] pos positions of particles
+ * @param[in] height heights of particles
+ * @param[in] col colors of particles
+ */
+void ParticleRenderer::Update(const std::vector<glm::vec2> &pos, const std::vector<float> &height, const std::vector<glm::vec3> &col) {
+    int n = pos.size();
+    cell_.resize(n);
+    std::fill(cell_start_.begin(), cell_start_.end(), 0);
+    std::fill(cell_height_.begin(), cell_height_.end(), glm::vec2(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()));
+    for(int i = 0; i < n; i++) {
+        glm::ivec2 index = glm::clamp(glm::ivec2(glm::floor((pos[i] - min_coord_) / cell_width_)), glm::ivec2(0), num_cells_ - 1);
+        int c = index[1] * num_cells_[0] + index[0];
+        cell_[i] = c;
+        cell_start_[c+1]++;
+        cell_height_[c][0] = glm::min(cell_height_[c][0], height[i]);
+        cell_height_[c][1] = glm::max(cell_height_[c][1], height[i]);
+    }
+    for(int c = 0; c < GetNumCells(); c++) {
+        cell_start_[c+1] += cell_start_[c];
+        cell_cursor_[c] = 0;
+    }
+
+    // k-th particle of cell goes to group of k mod 8 with bits reversed, groups of residues 0, 4, 2, 6, ...,
+    // so that first ceil(count/stride) slots hold every stride-th particle for strides up to 8
+    pos_.resize(n);
+    height_.resize(n);
+    col_.resize(n);
+    for(int i = 0; i < n; i++) {
+        int c = cell_[i];
+        int count = cell_start_[c+1] - cell_start_[c];
+        int k = cell_cursor_[c]++;
+        int q = k & 7;
+        int group = ((q & 1) << 2) | (q & 2) | ((q & 4) >> 2);
+        int slot = k >> 3;
+        for(int g = 0; g < group; g++) {
+            int r = ((g & 1) << 2) | (g & 2) | ((g & 4) >> 2);
+            slot += (count - r + 7) / 8;
+        }
+        int dst = cell_start_[c] + slot;
+        pos_[dst] = pos[i];
+        height_[dst] = height[i];
+        col_[dst] = col[i];
+    }
+    buffer_updated_ = false;
+}
+
+/**
+ * @brief collect ranges of cells inside frustum, decimated by distance to eye
+ * @param[in] frustum planes of frustum pointing inward, (normal, offset)
+ * @param[in] eye position of camera
+ * @return number of particles to draw
+ */
+int ParticleRenderer::Cull(const std::array<glm::vec4, 6> &frustum, const glm::vec3 &eye) {
+    for(int l = 0; l < kNumLodLevels; l++) {
+        first_[l].clear();
+        count_[l].clear();
+    }
+    num_visible_cells_ = 0;
+    num_drawn_ = 0;
+    for(int c = 0; c < GetNumCells(); c++) {
+        int start = cell_start_[c];
+        int count = cell_start_[c+1] - start;
+        if(count == 0) continue;
+        if(culling_ && !IsVisible(c, frustum)) continue;
+        num_visible_cells_++;
+
+        int level = 0;
+        if(lod_distance_ > 0.0f) {
+            glm::vec2 center = min_coord_ + (glm::vec2(c % num_cells_[0], c / num_cells_[0]) + 0.5f) * cell_width_;
+            float d = glm::length(glm::vec3(center[0], (cell_height_[c][0] + cell_height_[c][1]) / 2, center[1]) - eye);
+            while(level < kNumLodLevels-1 && d > lod_distance_ * (1 << level)) level++;
+        }
+        int stride = 1 << level;
+        count = (count + stride - 1) / stride;
+        num_drawn_ += count;
+
+        // cells drawn whole join into one range
+        std::vector<GLint> &first = first_[level];
+        std::vector<GLsizei> &counts = count_[level];
+        if(!first.empty() && first.back() + counts.back() == start) {
+            counts.back() += count;
+        } else {
+            first.push_back(start);
+            counts.push_back(count);
+        }
+    }
+    return num_drawn_;
+}
+
+/**
+ * @brief draw visible particles, decimated levels with larger points to cover the same area
+ * @param[in] frustum planes of frustum pointing inward
+ * @param[in] eye position of camera
+ */
+void ParticleRenderer::Draw(const std::array<glm::vec4, 6> &frustum, const glm::vec3 &eye) {
+    UpdateBuffer();
+    Cull(frustum, eye);
+    glBindVertexArray(vao_);
+    for(int l = 0; l < kNumLodLevels; l++) {
+        if(first_[l].empty()) continue;
+        glPointSize(kPointSize * std::sqrt(float(1 << l)));
+        glMultiDrawArrays(GL_POINTS, first_[l].data(), count_[l].data(), first_[l].size());
+    }
+    glPointSize(kPointSize);
+    glBindVertexArray(0);
+}
+
+/**
+ * @brief enable culling of cells outside frustum
+ * @param[in] culling cull or not
+ */
+void ParticleRenderer::SetCulling(bool culling) {
+    culling_ = culling;
+}
+
+/**
+ * @brief set distance beyond which cells are decimated
+ * @param[in] distance distance, 0 to draw all particles of visible cells
+ */
+void ParticleRenderer::SetLodDistance(float distance) {
+    lod_distance_ = distance;
+}
+
+/**
+ * @brief get whether cells outside frustum are culled
+ * @return cull or not
+ */
+bool ParticleRenderer::GetCulling() const {
+    return culling_;
+}
+
+/**
+ * @brief get distance beyond which cells are decimated
+ * @return distance
+ */
+float ParticleRenderer::GetLodDistance() const {
+    return lod_distance_;
+}
+
+/**
+ * @brief get number of cells
+ * @return number of cells
+ */
+int ParticleRenderer::GetNumCells() const {
+    return num_cells_[0] * num_cells_[1];
+}
+
+/**
+ * @brief get number of occupied cells inside frustum at last culling
+ * @return number of cells
+ */
+int ParticleRenderer::GetNumVisibleCells() const {
+    return num_visible_cells_;
+}
+
+/**
+ * @brief get number of particles
+ * @return number of particles
+ */
+int ParticleRenderer::GetNumParticles() const {
+    return pos_.size();
+}
+
+/**
+ * @brief get number of particles drawn at last culling
+ * @return number of particles
+ */
+int ParticleRenderer::GetNumDrawnParticles() const {
+    return num_drawn_;
+}
+
+/**
+ * @brief get memory held by renderer on host and device
+ * @return bytes
+ */
+size_t ParticleRenderer::GetMemoryUsage() const {
+    size_t bytes = pos_.capacity() * sizeof(glm::vec2) + height_.capacity() * sizeof(float) + col_.capacity() * sizeof(glm::vec3) + cell_.capacity() * sizeof(int);
+    bytes += (cell_start_.capacity() + cell_cursor_.capacity()) * sizeof(int) + cell_height_.capacity() * sizeof(glm::vec2);
+    bytes += buffer_size_ * (sizeof(glm::vec2) + sizeof(float) + sizeof(glm::vec3));
+    return bytes;
+}
+
+/**
+ * @brief test bounding box of cell against planes of frustum
+ * @param[in] cell cell
+ * @param[in] frustum planes of frustum pointing inward
+ * @return box not entirely outside of a plane
+ */
+bool ParticleRenderer::IsVisible(int cell, const std::array<glm::vec4, 6> &frustum) const {
+    glm::vec2 lo = min_coord_ + glm::vec2(cell % num_cells_[0], cell / num_cells_[0]) * cell_width_;
+    glm::vec2 hi = lo + cell_width_;
+    glm::vec3 min_corner = glm::vec3(lo[0], cell_height_[cell][0], lo[1]);
+    glm::vec3 max_corner = glm::vec3(hi[0], cell_height_[cell][1], hi[1]);
+    for(const glm::vec4 &plane: frustum) {
+        // corner farthest along normal
+        glm::vec3 p = glm::vec3(plane[0] > 0 ? max_corner[0] : min_corner[0],
+                                plane[1] > 0 ? max_corner[1] : min_corner[1],
+                                plane[2] > 0 ? max_corner[2] : min_corner[2]);
+        if(glm::dot(glm::vec3(plane), p) + plane[3] < 0) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief send binned particles to buffer
+ */
+void ParticleRenderer::UpdateBuffer() {
+    int n = pos_.size();
+    if(vao_ == 0) {
+        glGenVertexArrays(1, &vao_);
+        glGenBuffers(1, &vbo_);
+    }
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    if(n != buffer_size_) {
+        glBufferData(GL_ARRAY_BUFFER, n*(sizeof(glm::vec2) + sizeof(float) + sizeof(glm::vec3)), NULL, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(n*sizeof(glm::vec2)));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(n*(sizeof(glm::vec2) + sizeof(float))));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        buffer_size_ = n;
+        buffer_updated_ = false;
+    }
+    if(buffer_updated_) return;
+    // pos
+    glBufferSubData(GL_ARRAY_BUFFER, 0, n * sizeof(glm::vec2), pos_.data());
+    // height
+    glBufferSubData(GL_ARRAY_BUFFER, n * sizeof(glm::vec2), n * sizeof(float), height_.data());
+    // col
+    glBufferSubData(GL_ARRAY_BUFFER, n * (sizeof(glm::vec2) + sizeof(float)), n * sizeof(glm::vec3), col_.data());
+    buffer_updated_ = true;
+}
\ No newline at end of file
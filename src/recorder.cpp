@@ -0,0 +1,237 @@
+/**
+ * @file recorder.cpp
+ * @brief Implementation of offscreen frame recorder
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "recorder.hpp"
+
+/**
+ * @brief constructor, needs current GL context
+ * @param[in] width width of frames
+ * @param[in] height height of frames
+ * @param[in] prefix path of images without frame number
+ * @param[in] num_pixel_buffers number of pixel buffers in ring
+ * @param[in] num_frames_in_flight number of frames read back but not yet written
+ */
+Recorder::Recorder(int width, int height, const std::string &prefix, int num_pixel_buffers, int num_frames_in_flight)
+: width_(width), height_(height), num_issued_(0), num_collected_(0), num_failed_(0), done_(false), prefix_(prefix), readback_seconds_(0.0), stall_seconds_(0.0), write_seconds_(0.0) {
+    // color and depth attachments
+    glGenFramebuffers(1, &fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glGenRenderbuffers(1, &color_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+    glGenRenderbuffers(1, &depth_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width_, height_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Framebuffer of " << width_ << "x" << height_ << " is incomplete" << std::endl;
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // RGBA rows need no pack alignment
+    size_t size = (size_t)width_ * height_ * 4;
+    pbo_.resize(std::max(num_pixel_buffers, 1));
+    glGenBuffers(pbo_.size(), pbo_.data());
+    for(GLuint pbo: pbo_) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    frames_.resize(std::max(num_frames_in_flight, 1), std::vector<unsigned char>(size));
+    for(int k = 0; k < frames_.size(); k++) free_.push_back(k);
+    row_.resize(width_ * 3);
+    writer_ = std::thread(&Recorder::Write, this);
+}
+
+/**
+ * @brief destructor
+ */
+Recorder::~Recorder() {
+    Finish();
+    glDeleteBuffers(pbo_.size(), pbo_.data());
+    glDeleteRenderbuffers(1, &depth_);
+    glDeleteRenderbuffers(1, &color_);
+    glDeleteFramebuffers(1, &fbo_);
+}
+
+/**
+ * @brief direct drawing into framebuffer
+ */
+void Recorder::Begin() {
+    glGetIntegerv(GL_VIEWPORT, viewport_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glViewport(0, 0, width_, height_);
+}
+
+/**
+ * @brief issue read of drawn frame and collect the oldest one when ring is full
+ */
+void Recorder::End() {
+    // read lands in pixel buffer without waiting for drawing to finish
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[num_issued_ % pbo_.size()]);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+    num_issued_++;
+    if(num_issued_ - num_collected_ == pbo_.size()) Collect();
+}
+
+/**
+ * @brief collect frames still in pixel buffers and wait until all are written
+ */
+void Recorder::Finish() {
+    if(done_) return;
+    while(num_collected_ < num_issued_) Collect();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    cond_.notify_all();
+    writer_.join();
+}
+
+/**
+ * @brief get width of frames
+ * @return width
+ */
+int Recorder::GetWidth() const {
+    return width_;
+}
+
+/**
+ * @brief get height of frames
+ * @return height
+ */
+int Recorder::GetHeight() const {
+    return height_;
+}
+
+/**
+ * @brief get number of frames issued
+ * @return number of frames
+ */
+int Recorder::GetNumFrames() const {
+    return num_issued_;
+}
+
+/**
+ * @brief get number of frames not written because their pixel buffer could not be mapped
+ * @return number of frames
+ */
+int Recorder::GetNumFailedFrames() const {
+    return num_failed_;
+}
+
+/**
+ * @brief get seconds spent mapping pixel buffers on render thread
+ * @return seconds
+ */
+double Recorder::GetReadbackSeconds() const {
+    return readback_seconds_;
+}
+
+/**
+ * @brief get seconds render thread waited for writer to free a frame
+ * @return seconds
+ */
+double Recorder::GetStallSeconds() const {
+    return stall_seconds_;
+}
+
+/**
+ * @brief get seconds writer spent encoding and writing, valid after Finish()
+ * @return seconds
+ */
+double Recorder::GetWriteSeconds() const {
+    return write_seconds_;
+}
+
+/**
+ * @brief map oldest pixel buffer and hand its frame to writer, frame is skipped when mapping fails
+ */
+void Recorder::Collect() {
+    auto start = std::chrono::steady_clock::now();
+    int k;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&] { return !free_.empty(); });
+        k = free_.back();
+        free_.pop_back();
+    }
+    auto mapped = std::chrono::steady_clock::now();
+    stall_seconds_ += std::chrono::duration<double>(mapped - start).count();
+
+    std::vector<unsigned char> &frame = frames_[k];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[num_collected_ % pbo_.size()]);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame.size(), GL_MAP_READ_BIT);
+    if(pixels != nullptr) {
+        std::memcpy(frame.data(), pixels, frame.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::cerr << "Failed to map pixel buffer of frame " << num_collected_ << std::endl;
+        num_failed_++;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - mapped).count();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(pixels != nullptr) {
+            queue_.push_back(std::make_pair(num_collected_, k));
+        } else {
+            free_.push_back(k);
+        }
+    }
+    cond_.notify_all();
+    num_collected_++;
+}
+
+/**
+ * @brief write queued frames as binary PPM, top row first, until finished
+ */
+void Recorder::Write() {
+    while(true) {
+        std::pair<int, int> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [&] { return done_ || !queue_.empty(); });
+            if(queue_.empty()) return;
+            item = queue_.front();
+            queue_.pop_front();
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::ostringstream path;
+        path << prefix_ << std::setw(5) << std::setfill('0') << item.first << ".ppm";
+        std::ofstream file(path.str(), std::ios::binary);
+        if(!file) {
+            std::cerr << "Failed to open " << path.str() << std::endl;
+        } else {
+            // GL rows start at bottom
+            const std::vector<unsigned char> &frame = frames_[item.second];
+            file << "P6\n" << width_ << " " << height_ << "\n255\n";
+            for(int y = height_-1; y >= 0; y--) {
+                const unsigned char *src = frame.data() + (size_t)y * width_ * 4;
+                for(int x = 0; x < width_; x++) {
+                    row_[3*x+0] = src[4*x+0];
+                    row_[3*x+1] = src[4*x+1];
+                    row_[3*x+2] = src[4*x+2];
+                }
+                file.write((const char*)row_.data(), row_.size());
+            }
+        }
+        write_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(item.second);
+        }
+        cond_.notify_all();
+    }
+}
\ No newline at end of file
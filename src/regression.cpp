@@ -0,0 +1,280 @@
+/**
+ * @file regression.cpp
+ * @brief Implementation of golden trajectory regression
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "regression.hpp"
+
+static const int kTrajectoryMagic = 0x47485053;
+static const int kTrajectoryVersion = 1;
+
+// id, position, interpolated density and height of a particle
+static const size_t kRecordSize = sizeof(int) + 4 * sizeof(double);
+
+/**
+ * @brief append snapshot of fluid particles to message
+ * @param[in] simulater simulater
+ * @param[in] step step
+ * @param[out] buf message
+ */
+template<typename Real, typename Accum>
+static void PackSnapshot(const Simulater<Real, Accum> &simulater, int step, std::vector<char> *buf) {
+    const auto &pos = simulater.GetPositions();
+    const auto &interp_dens = simulater.GetInterpDensities();
+    const auto &height = simulater.GetHeights();
+    const auto &attr = simulater.GetAttributes();
+    const auto &id = simulater.GetIds();
+    Pack(step, buf);
+    Pack(simulater.GetNumParticles(kFluid), buf);
+    for(int i = 0; i < pos.size(); i++) {
+        if(attr[i] != kFluid) continue;
+        Pack(id[i], buf);
+        Pack((double)pos[i][0], buf);
+        Pack((double)pos[i][1], buf);
+        Pack((double)interp_dens[i], buf);
+        Pack((double)height[i], buf);
+    }
+}
+
+/**
+ * @brief read snapshot, checking that it lies within message
+ * @param[in] buf message
+ * @param[in,out] offset read position
+ * @param[in] name name of message in errors
+ * @param[out] step step
+ * @param[in,out] snapshot position, interpolated density and height by id, particles are added to it
+ * @return succeeded or not
+ */
+static bool ReadSnapshot(const std::vector<char> &buf, size_t *offset, const std::string &name, int *step, std::unordered_map<int, glm::dvec4> *snapshot) {
+    if(buf.size() - *offset < 2 * sizeof(int)) {
+        std::cerr << name << ": truncated snapshot header at byte " << *offset << std::endl;
+        return false;
+    }
+    *step = Unpack<int>(buf, offset);
+    int n = Unpack<int>(buf, offset);
+    if(n < 0 || (buf.size() - *offset) / kRecordSize < (size_t)n) {
+        std::cerr << name << ": snapshot of step " << *step << " has " << n << " particles but " << buf.size() - *offset << " bytes left" << std::endl;
+        return false;
+    }
+    for(int k = 0; k < n; k++) {
+        int id = Unpack<int>(buf, offset);
+        glm::dvec4 &record = (*snapshot)[id];
+        for(int c = 0; c < 4; c++) record[c] = Unpack<double>(buf, offset);
+    }
+    return true;
+}
+
+/**
+ * @brief run scene in one process and take snapshots
+ * @param[in] scenario scenario
+ * @param[in] num_steps number of steps
+ * @param[in] interval steps between snapshots
+ * @param[out] buf snapshots
+ */
+template<typename Real, typename Accum>
+static void RunSnapshots(const Scenario &scenario, int num_steps, int interval, std::vector<char> *buf) {
+    Simulater<Real, Accum> simulater(scenario);
+    PackSnapshot(simulater, 0, buf);
+    for(int step = 1; step <= num_steps; step++) {
+        simulater.Evolve();
+        if(step % interval == 0) PackSnapshot(simulater, step, buf);
+    }
+}
+
+/**
+ * @brief compare reference snapshots with those of a rerun and report largest deviations
+ * @param[in] buf reference message
+ * @param[in] offset read position of first reference snapshot
+ * @param[in] path name of reference in errors
+ * @param[in] runs snapshots of rerun, one message per subdomain
+ * @param[in] tolerance tolerance of position, interpolated density and height
+ * @return exit status
+ */
+static int CompareSnapshots(const std::vector<char> &buf, size_t offset, const std::string &path, const std::vector<std::vector<char>> &runs, const Tolerance &tolerance) {
+    std::vector<size_t> run_offsets(runs.size(), 0);
+
+    // largest deviation over all snapshots
+    double pos_err = 0.0;
+    double dens_err = 0.0;
+    double height_err = 0.0;
+    int first_failure = -1;
+    int num_snapshots = 0;
+    std::unordered_map<int, glm::dvec4> reference;
+    std::unordered_map<int, glm::dvec4> rerun;
+    while(offset < buf.size()) {
+        int frame;
+        reference.clear();
+        if(!ReadSnapshot(buf, &offset, path, &frame, &reference)) return 1;
+
+        // subdomains own disjoint particles of the same step
+        rerun.clear();
+        for(int r = 0; r < runs.size(); r++) {
+            int step;
+            std::string name = "rerun of subdomain " + std::to_string(r);
+            if(run_offsets[r] >= runs[r].size()) {
+                std::cerr << name << ": no snapshot of step " << frame << std::endl;
+                return 1;
+            }
+            if(!ReadSnapshot(runs[r], &run_offsets[r], name, &step, &rerun)) return 1;
+            if(step != frame) {
+                std::cerr << name << ": snapshot of step " << step << " where " << path << " has step " << frame << std::endl;
+                return 1;
+            }
+        }
+        num_snapshots++;
+
+        bool failed = reference.size() != rerun.size();
+        for(const auto &entry: reference) {
+            auto it = rerun.find(entry.first);
+            if(it == rerun.end()) {
+                failed = true;
+                continue;
+            }
+            const glm::dvec4 &ref = entry.second;
+            const glm::dvec4 &cur = it->second;
+            double e_pos = glm::length(glm::dvec2(cur[0], cur[1]) - glm::dvec2(ref[0], ref[1]));
+            double e_dens = std::abs(cur[2] - ref[2]);
+            double e_height = std::abs(cur[3] - ref[3]);
+            pos_err = glm::max(pos_err, e_pos);
+            dens_err = glm::max(dens_err, e_dens);
+            height_err = glm::max(height_err, e_height);
+            if(e_pos > tolerance.pos || e_dens > tolerance.interp_dens || e_height > tolerance.height) failed = true;
+        }
+        if(failed && first_failure < 0) first_failure = frame;
+    }
+
+    std::cout << "compared " << num_snapshots << " snapshots" << std::endl;
+    std::cout << "max pos error         " << pos_err << " (tolerance " << tolerance.pos << ")" << std::endl;
+    std::cout << "max interp_dens error " << dens_err << " (tolerance " << tolerance.interp_dens << ")" << std::endl;
+    std::cout << "max height error      " << height_err << " (tolerance " << tolerance.height << ")" << std::endl;
+    if(first_failure >= 0) {
+        std::cout << "FAILED from step " << first_failure << std::endl;
+        return 1;
+    }
+    if(pos_err == 0.0 && dens_err == 0.0 && height_err == 0.0) {
+        std::cout << "PASSED (bitwise identical)" << std::endl;
+    } else {
+        std::cout << "PASSED" << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * @brief run scene in one process and decomposed, and compare snapshots of both
+ * @param[in] scenario scenario, summed deterministically in both runs
+ * @param[in] num_subdomains number of subdomains
+ * @param[in] num_steps number of steps
+ * @param[in] interval steps between snapshots
+ * @param[in] tolerance tolerance of position, interpolated density and height
+ * @return exit status
+ */
+int CheckDecomposed(const Scenario &scenario, int num_subdomains, int num_steps, int interval, const Tolerance &tolerance) {
+    if(num_subdomains < 1 || num_steps < 0 || interval <= 0) {
+        std::cerr << "Invalid number of subdomains, steps or interval" << std::endl;
+        return 1;
+    }
+    Scenario config = scenario;
+    config.deterministic = true;
+    std::vector<char> serial;
+    RunSnapshots<float, float>(config, num_steps, interval, &serial);
+
+    std::vector<std::vector<char>> runs;
+    double seconds;
+    int num_fluid;
+    if(RunDecomposed(config, num_subdomains, num_steps, false, &seconds, &num_fluid, PackSnapshot<float, float>, interval, &runs) != 0) {
+        std::cerr << "Decomposed run failed" << std::endl;
+        return 1;
+    }
+    return CompareSnapshots(serial, 0, "serial run", runs, tolerance);
+}
+
+/**
+ * @brief run fixed scene and record reference trajectory
+ * @param[in] scale scale of domain
+ * @param[in] num_steps number of steps
+ * @param[in] interval steps between snapshots
+ * @param[in] deterministic sum neighbor contributions in order of id
+ * @param[in] path output file
+ * @return exit status
+ */
+int RecordTrajectory(float scale, int num_steps, int interval, bool deterministic, const std::string &path) {
+    if(num_steps < 0 || interval <= 0) {
+        std::cerr << "Invalid number of steps or interval" << std::endl;
+        return 1;
+    }
+    Scenario scenario(scale);
+    scenario.deterministic = deterministic;
+
+    std::vector<char> buf;
+    Pack(kTrajectoryMagic, &buf);
+    Pack(kTrajectoryVersion, &buf);
+    Pack(scale, &buf);
+    Pack(num_steps, &buf);
+    Pack(interval, &buf);
+    size_t header_size = buf.size();
+    RunSnapshots<float, float>(scenario, num_steps, interval, &buf);
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return 1;
+    }
+    file.write(buf.data(), buf.size());
+    size_t offset = header_size;
+    int step;
+    std::unordered_map<int, glm::dvec4> snapshot;
+    ReadSnapshot(buf, &offset, path, &step, &snapshot);
+    std::cout << "recorded " << num_steps / interval + 1 << " snapshots of " << snapshot.size() << " fluid particles to " << path << std::endl;
+    return 0;
+}
+
+/**
+ * @brief rerun scene of reference trajectory with another configuration and compare snapshots
+ * @param[in] path reference file
+ * @param[in] tolerance tolerance of position, interpolated density and height
+ * @param[in] variant configuration of rerun
+ * @return exit status
+ */
+int CompareTrajectory(const std::string &path, const Tolerance &tolerance, const TrajectoryVariant &variant) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return 1;
+    }
+    std::vector<char> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t offset = 0;
+    if(buf.size() < 5 * sizeof(int) || Unpack<int>(buf, &offset) != kTrajectoryMagic || Unpack<int>(buf, &offset) != kTrajectoryVersion) {
+        std::cerr << path << " is not a trajectory file" << std::endl;
+        return 1;
+    }
+    float scale = Unpack<float>(buf, &offset);
+    int num_steps = Unpack<int>(buf, &offset);
+    int interval = Unpack<int>(buf, &offset);
+    if(num_steps < 0 || interval <= 0) {
+        std::cerr << path << ": invalid number of steps " << num_steps << " or interval " << interval << std::endl;
+        return 1;
+    }
+
+    // rerun whole trajectory, one run per subdomain
+    Scenario scenario(scale);
+    scenario.deterministic = variant.deterministic;
+    scenario.compact_state = variant.compact_state;
+    scenario.tune_grid = variant.tune_grid;
+    scenario.sleeping = variant.sleeping;
+    std::vector<std::vector<char>> runs(1);
+    if(variant.num_subdomains > 1) {
+        double seconds;
+        int num_fluid;
+        if(RunDecomposed(scenario, variant.num_subdomains, num_steps, false, &seconds, &num_fluid, PackSnapshot<float, float>, interval, &runs) != 0) {
+            std::cerr << "Decomposed run failed" << std::endl;
+            return 1;
+        }
+    } else if(variant.mixed_precision) {
+        RunSnapshots<float, double>(scenario, num_steps, interval, &runs[0]);
+    } else {
+        RunSnapshots<float, float>(scenario, num_steps, interval, &runs[0]);
+    }
+    return CompareSnapshots(buf, offset, path, runs, tolerance);
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+/**
+ * @file scenario.cpp
+ * @brief Implementation of scenario
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "scenario.hpp"
+
+/**
+ * @brief constructor with the built-in dam scene
+ * @param[in] scale scale of domain
+ */
+Scenario::Scenario(float scale)
+: scale(scale), terrain(Flat), periodic(false), boundary_model(kBoundaryWall), dt(0.002f), integrator(kIntegratorEuler), kernel_particles(20), kernel("poly6"), num_boundary_layers(3), adaptive(false), variable_smoothing(false), implicit_viscosity(false), compact_state(false), deterministic(false), sleeping(true), tune_grid(false), cell_ratio(0.0f), gauge_path("gauges.bin"), gauge_interval(10), weak_scaling(false), num_members(0), ensemble_seed(1), vary_inflow(false), min_inflow(0.0f), max_inflow(0.0f), visc_scale(1.0f), ensemble_path("ensemble.csv") {
+    phases = {kPhaseBoundary, kPhaseA, kPhaseB};
+    regions.push_back(FluidRegion(glm::vec2(0.0f), glm::vec2(1.0f), glm::vec2(0.5f), {0.0f, 0.5f, 0.5f}));
+}
+
+/**
+ * @brief find ground function by name
+ * @param[in] name name
+ * @param[out] fn ground function
+ * @return found or not
+ */
+static bool FindTerrain(const std::string &name, ground *fn) {
+    if(name == "flat") {
+        *fn = Flat;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief find integrator by name
+ * @param[in] name name
+ * @param[out] integrator integrator
+ * @return found or not
+ */
+static bool FindIntegrator(const std::string &name, Integrator *integrator) {
+    for(int k = 0; k < kNumIntegrators; k++) {
+        if(name != kIntegratorName[k]) continue;
+        *integrator = (Integrator)k;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief check kernel name is known to simulater
+ * @param[in] name name
+ * @return known or not
+ */
+static bool IsKernel(const std::string &name) {
+    return name == "poly6" || name == "spiky";
+}
+
+/**
+ * @brief read values until end of line
+ * @param[in,out] line line
+ * @param[out] values values
+ */
+template<typename T>
+static void ReadAll(std::istringstream &line, std::vector<T> *values) {
+    values->clear();
+    T value;
+    while(line >> value) values->push_back(value);
+}
+
+/**
+ * @brief load scenario file
+ * @param[in] path scenario file
+ * @param[out] scenario scenario, keys missing in file keep their values
+ * @return succeeded or not
+ */
+bool LoadScenario(const std::string &path, Scenario *scenario) {
+    std::ifstream file(path);
+    if(!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    bool phases_given = false;
+    bool regions_given = false;
+    std::string text;
+    for(int line_number = 1; std::getline(file, text); line_number++) {
+        text = text.substr(0, text.find('#'));
+        std::istringstream line(text);
+        std::string key;
+        if(!(line >> key)) continue;
+
+        bool ok = true;
+        if(key == "scale") {
+            ok = (bool)(line >> scenario->scale);
+        } else if(key == "terrain") {
+            std::string name;
+            ok = (line >> name) && FindTerrain(name, &scenario->terrain);
+        } else if(key == "periodic") {
+            std::string axes;
+            ok = (line >> axes) && (axes == "none" || axes == "x" || axes == "z" || axes == "xz");
+            scenario->periodic = glm::bvec2(axes == "x" || axes == "xz", axes == "z" || axes == "xz");
+        } else if(key == "boundary") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "wall" || mode == "particles");
+            scenario->boundary_model = mode == "particles" ? kBoundaryParticle : kBoundaryWall;
+        } else if(key == "obstacle") {
+            // circle x z radius, box min_x min_z max_x max_z, polygon x z x z x z ...
+            std::string shape;
+            std::vector<float> values;
+            line >> shape;
+            ReadAll(line, &values);
+            std::vector<glm::vec2> points;
+            for(int k = 0; k + 1 < values.size(); k += 2) points.push_back(glm::vec2(values[k], values[k+1]));
+            if(shape == "circle") {
+                ok = values.size() == 3 && values[2] > 0.0f;
+                if(ok) scenario->obstacles.push_back(Obstacle(kObstacleCircle, {points[0]}, values[2]));
+            } else if(shape == "box") {
+                ok = values.size() == 4 && points[0].x < points[1].x && points[0].y < points[1].y;
+                if(ok) scenario->obstacles.push_back(Obstacle(kObstacleBox, points));
+            } else if(shape == "polygon") {
+                ok = values.size() % 2 == 0 && points.size() >= 3;
+                if(ok) scenario->obstacles.push_back(Obstacle(kObstaclePolygon, points));
+            } else {
+                ok = false;
+            }
+        } else if(key == "dt") {
+            ok = (bool)(line >> scenario->dt);
+        } else if(key == "integrator") {
+            std::string name;
+            ok = (line >> name) && FindIntegrator(name, &scenario->integrator);
+        } else if(key == "kernel_particles") {
+            ok = (bool)(line >> scenario->kernel_particles);
+        } else if(key == "kernel") {
+            ok = (line >> scenario->kernel) && IsKernel(scenario->kernel);
+        } else if(key == "boundary_layers") {
+            ok = (bool)(line >> scenario->num_boundary_layers);
+        } else if(key == "adaptive") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "on" || mode == "off");
+            scenario->adaptive = mode == "on";
+        } else if(key == "smoothing") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "fixed" || mode == "variable");
+            scenario->variable_smoothing = mode == "variable";
+        } else if(key == "viscosity") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "explicit" || mode == "implicit");
+            scenario->implicit_viscosity = mode == "implicit";
+        } else if(key == "state") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "full" || mode == "compact");
+            scenario->compact_state = mode == "compact";
+        } else if(key == "reduction") {
+            // neighbor contributions summed in order of id or of cells
+            std::string mode;
+            ok = (line >> mode) && (mode == "deterministic" || mode == "fast");
+            scenario->deterministic = mode == "deterministic";
+        } else if(key == "sleep") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "on" || mode == "off");
+            scenario->sleeping = mode == "on";
+        } else if(key == "grid") {
+            // auto, or cell width over effective radius
+            std::string mode;
+            ok = (bool)(line >> mode);
+            scenario->tune_grid = mode == "auto";
+            if(ok && !scenario->tune_grid) {
+                std::istringstream ratio(mode);
+                ok = (ratio >> scenario->cell_ratio) && scenario->cell_ratio > 0.0f;
+            }
+        } else if(key == "phase") {
+            float mass, dens, visc;
+            glm::vec3 col;
+            ok = (bool)(line >> mass >> dens >> visc >> col.r >> col.g >> col.b);
+            if(!phases_given) scenario->phases.clear();
+            phases_given = true;
+            if(ok) scenario->phases.push_back(Phase(mass, dens, visc, col));
+        } else if(key == "fluid") {
+            glm::vec2 min_coord, max_coord, vel;
+            std::vector<float> frac;
+            ok = (bool)(line >> min_coord[0] >> min_coord[1] >> max_coord[0] >> max_coord[1] >> vel[0] >> vel[1]);
+            ReadAll(line, &frac);
+            if(!regions_given) scenario->regions.clear();
+            regions_given = true;
+            if(ok) scenario->regions.push_back(FluidRegion(min_coord, max_coord, vel, frac));
+        } else if(key == "gauge") {
+            glm::vec2 point;
+            ok = (bool)(line >> point[0] >> point[1]);
+            if(ok) scenario->gauges.push_back(point);
+        } else if(key == "gauge_line") {
+            // n gauges evenly spaced from first to second point
+            glm::vec2 first, last;
+            int n;
+            ok = (line >> first[0] >> first[1] >> last[0] >> last[1] >> n) && n > 0;
+            for(int k = 0; ok && k < n; k++) {
+                scenario->gauges.push_back(n > 1 ? first + (last - first) * (float)k / (float)(n - 1) : first);
+            }
+        } else if(key == "gauge_output") {
+            ok = (line >> scenario->gauge_path >> scenario->gauge_interval) && scenario->gauge_interval > 0;
+        } else if(key == "sweep") {
+            std::string param;
+            line >> param;
+            if(param == "scale") {
+                ReadAll(line, &scenario->sweep_scales);
+            } else if(param == "subdomains") {
+                ReadAll(line, &scenario->sweep_subdomains);
+            } else if(param == "kernel") {
+                ReadAll(line, &scenario->sweep_kernels);
+                for(const std::string &name: scenario->sweep_kernels) ok = ok && IsKernel(name);
+            } else if(param == "threads") {
+                ReadAll(line, &scenario->sweep_threads);
+                for(int num_threads: scenario->sweep_threads) ok = ok && num_threads > 0;
+            } else {
+                ok = false;
+            }
+        } else if(key == "scaling") {
+            std::string mode;
+            ok = (line >> mode) && (mode == "strong" || mode == "weak");
+            scenario->weak_scaling = mode == "weak";
+        } else if(key == "ensemble") {
+            ok = (line >> scenario->num_members) && scenario->num_members > 0;
+            if(ok && !(line >> scenario->ensemble_seed)) scenario->ensemble_seed = 1;
+        } else if(key == "vary") {
+            std::string param;
+            line >> param;
+            if(param == "inflow") {
+                ok = (bool)(line >> scenario->min_inflow[0] >> scenario->min_inflow[1] >> scenario->max_inflow[0] >> scenario->max_inflow[1]);
+                scenario->vary_inflow = ok;
+            } else if(param == "visc") {
+                ok = (line >> scenario->visc_scale[0] >> scenario->visc_scale[1]) && scenario->visc_scale[0] >= 0.0f;
+            } else {
+                ok = false;
+            }
+        } else if(key == "ensemble_output") {
+            ok = (bool)(line >> scenario->ensemble_path);
+        } else {
+            ok = false;
+        }
+
+        if(!ok) {
+            std::cerr << path << ":" << line_number << ": invalid line \"" << text << "\"" << std::endl;
+            return false;
+        }
+    }
+
+    if(scenario->phases.size() < 2) {
+        std::cerr << path << ": needs a boundary phase and at least one fluid phase" << std::endl;
+        return false;
+    }
+    if(scenario->boundary_model == kBoundaryParticle && (!scenario->obstacles.empty() || scenario->periodic.x || scenario->periodic.y)) {
+        std::cerr << path << ": obstacles and periodic sides need boundary wall" << std::endl;
+        return false;
+    }
+    if(scenario->phases.size() > kMaxPhases) {
+        std::cerr << path << ": at most " << kMaxPhases << " phases" << std::endl;
+        return false;
+    }
+    for(const FluidRegion &region: scenario->regions) {
+        if(region.frac.size() != scenario->phases.size()) {
+            std::cerr << path << ": fluid fractions must be given for each of " << scenario->phases.size() << " phases" << std::endl;
+            return false;
+        }
+        if(std::count_if(region.frac.begin(), region.frac.end(), [](float f) { return f > 0.0f; }) > kMaxPhasesPerParticle) {
+            std::cerr << path << ": a particle holds at most " << kMaxPhasesPerParticle << " phases" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
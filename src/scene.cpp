@@ -11,8 +11,9 @@
  * @brief constructor
  * @param[in] window_width window width
  * @param[in] window_height window height
+ * @param[in] scenario scenario
  */
-Scene::Scene(int window_width, int window_height) {
+Scene::Scene(int window_width, int window_height, const Scenario &scenario) {
     // light
     glm::vec3 direction = glm::normalize(glm::vec3(-1.0f, -1.0f, -1.0f));
     glm::vec3 ambient = glm::vec3(0.2f, 0.2f, 0.2f);
@@ -36,10 +37,14 @@ Scene::Scene(int window_width, int window_height) {
     shader_ = std::make_unique<Shader>(vertex_path.c_str(), fragment_path.c_str());
 
     terrain_shader_ = std::make_unique<Shader>("../shader/terrain.vert", "../shader/terrain.frag");
+    surface_shader_ = std::make_unique<Shader>("../shader/surface.vert", "../shader/surface.frag");
+    draw_surface_ = false;
 
     // simulater
-    float scale = 4.0f;
-    simulater_ = std::make_unique<Simulater>(scale);
+    simulater_ = std::make_unique<Simulater<float>>(scenario);
+
+    // dashboard
+    dashboard_ = std::make_unique<Dashboard>(120);
 }
 
 /**
@@ -59,6 +64,16 @@ void Scene::ImGui(GLFWwindow* window) {
     ImGui::Separator();
     camera_->ImGui(window);
     ImGui::Separator();
+    ImGui::Checkbox("water surface", &draw_surface_);
+    ParticleRenderer *renderer = simulater_->GetParticleRenderer();
+    bool culling = renderer->GetCulling();
+    if(ImGui::Checkbox("frustum culling", &culling)) renderer->SetCulling(culling);
+    float lod_distance = renderer->GetLodDistance();
+    if(ImGui::InputFloat("lod distance", &lod_distance, 0.5f, 2.0f)) renderer->SetLodDistance(glm::max(lod_distance, 0.0f));
+    ImGui::Text("cells %d / %d, particles %d / %d", renderer->GetNumVisibleCells(), renderer->GetNumCells(), renderer->GetNumDrawnParticles(), renderer->GetNumParticles());
+    ImGui::Separator();
+    dashboard_->ImGui(window);
+    ImGui::Separator();
 }
 
 /**
@@ -84,7 +99,11 @@ void Scene::Draw() {
     glm::mat4 view = camera_->GenViewMatrix();
     glm::mat4 projection = camera_->GenProjectionMatrix();
 
-    DrawParticles(view, projection);    
+    if(draw_surface_) {
+        DrawSurface(view, projection);
+    } else {
+        DrawParticles(view, projection);
+    }
     DrawTerrain(view, projection);
 }
 
@@ -99,7 +118,7 @@ void Scene::DrawParticles(const glm::mat4 &view, const glm::mat4 &projection) {
     shader_->SetMat4("model", model);
     shader_->SetMat4("view", view);
     shader_->SetMat4("projection", projection);
-    simulater_->DrawParticles();
+    simulater_->DrawParticles(camera_->GenFrustum(), camera_->GetPosition());
 }
 
 /**
@@ -116,9 +135,29 @@ void Scene::DrawTerrain(const glm::mat4 &view, const glm::mat4 &projection) {
     simulater_->DrawTerrain();
 }
 
+/**
+ * @brief draw water surface
+ * @param[in] view view matrix
+ * @param[in] projection projection matrix
+ */
+void Scene::DrawSurface(const glm::mat4 &view, const glm::mat4 &projection) {
+    surface_shader_->Use();
+    glm::mat4 model(1.0f);
+    surface_shader_->SetMat4("model", model);
+    surface_shader_->SetMat4("view", view);
+    surface_shader_->SetMat4("projection", projection);
+    surface_shader_->SetVec3("light.direction", light_->GetDirection());
+    surface_shader_->SetVec3("light.ambient", light_->GetAmbient());
+    surface_shader_->SetVec3("light.diffuse", light_->GetDiffuse());
+    surface_shader_->SetVec3("color", kSurfaceColor);
+    simulater_->DrawSurface();
+}
+
 /**
  * @brief update scene
  */
 void Scene::Update() {
     simulater_->Evolve();
+    simulater_->GetStatistics(&stats_);
+    dashboard_->Record(stats_);
 }
\ No newline at end of file
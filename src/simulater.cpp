@@ -7,125 +7,533 @@
 
 #include "simulater.hpp"
 
+/**
+ * @brief constructor with the built-in scene
+ * @param[in] scale scale of domain
+ */
+template<typename Real, typename Accum>
+Simulater<Real, Accum>::Simulater(float scale)
+: Simulater(Scenario(scale)) {
+
+}
+
 /**
  * @brief constructor
+ * @param[in] scenario scenario
+ * @param[in] shared data of another simulater with the same domain, kernel and boundary phase, built when empty
  */
-Simulater::Simulater(float scale) {
+template<typename Real, typename Accum>
+Simulater<Real, Accum>::Simulater(const Scenario &scenario, const SharedData<Real> &shared) {
     // scale
-    min_coord_ = glm::vec2(-scale/2.0f);
-    max_coord_ = glm::vec2( scale/2.0f);
+    min_coord_ = real2(-scenario.scale/2.0f);
+    max_coord_ = real2( scenario.scale/2.0f);
+    periodic_ = scenario.periodic;
+    period_ = max_coord_ - min_coord_;
 
     // simulation
-    dt_ = 0.002;
-    
+    dt_ = scenario.dt;
+
+    // time integration
+    integrator_ = scenario.integrator;
+    verlet_lambda_ = 0.65;
+
     // kernel
-    kernel_particles_ = 20;
-    kernel_ = Poly6;
-    gkernel_ = GradSpiky;
-    lkernel_ = LaplaceViscosity;
+    kernel_particles_ = scenario.kernel_particles;
+    kernel_ = (scenario.kernel == "spiky") ? Spiky<Real> : Poly6<Real>;
+    gkernel_ = GradSpiky<Real>;
+    lkernel_ = LaplaceViscosity<Real>;
 
     // particle
-    effective_rad_ = sqrtf(2.0 * kernel_particles_ / (glm::pi<float>() * 998.29));
-    particle_rad_ = 0.5 * effective_rad_ * sqrtf(kPi / kernel_particles_);
+    effective_rad_ = std::sqrt(2.0 * kernel_particles_ / (glm::pi<Real>() * 998.29));
+    particle_rad_ = 0.5 * effective_rad_ * std::sqrt(kPi / kernel_particles_);
     num_particles_.resize(kNumAttributes);
+    next_id_ = 0;
+
+    // smoothing length
+    variable_smoothing_ = scenario.variable_smoothing;
+    target_neighbors_ = kernel_particles_;
+    min_smoothing_len_ = effective_rad_ / 4;
+    max_smoothing_len_ = effective_rad_ * 2;
+
+    // reduction
+    deterministic_ = scenario.deterministic;
+
+    // compact state
+    compact_state_ = scenario.compact_state;
+
+    // viscosity
+    implicit_viscosity_ = scenario.implicit_viscosity;
+    viscosity_tol_ = 1.0e-4;
+    max_viscosity_iterations_ = 100;
+    viscosity_iterations_ = 0;
+
+    // refinement
+    adaptive_ = scenario.adaptive;
+    split_depth_ = 0.3;
+    split_frac_ = 0.5;
+    merge_depth_ = 0.8;
+    merge_vel_ = 0.05;
+    min_mass_scale_ = 1.0 / 16.0;
+
+    // activity
+    sleep_vel_ = 1.0e-3;
+    sleep_acc_ = 1.0e-2;
+    sleep_steps_ = scenario.sleeping ? 100 : std::numeric_limits<int>::max();
 
     // boundary
-    num_boundary_layers_ = 3;
+    boundary_model_ = scenario.boundary_model;
+    num_boundary_layers_ = scenario.num_boundary_layers;
     min_boundary_coord_ = min_coord_ - num_boundary_layers_ * 2 * particle_rad_;
     max_boundary_coord_ = max_coord_ + num_boundary_layers_ * 2 * particle_rad_;
+    if(shared.wall) {
+        wall_ = shared.wall;
+    } else {
+        auto wall = std::make_shared<Wall<Real>>(min_coord_, max_coord_);
+        wall->SetOpen(periodic_);
+        for(const Obstacle &obstacle: scenario.obstacles) {
+            std::vector<real2> points;
+            for(const glm::vec2 &p: obstacle.points) points.push_back(min_coord_ + real2(p) * (max_coord_ - min_coord_));
+            if(obstacle.shape == kObstacleCircle) {
+                wall->AddCircle(points[0], obstacle.radius * (max_coord_[0] - min_coord_[0]));
+            } else if(obstacle.shape == kObstacleBox) {
+                wall->AddBox(points[0], points[1]);
+            } else {
+                wall->AddPolygon(points);
+            }
+        }
+        // fluid particles meet the wall with their own smoothing lengths
+        Real min_h = variable_smoothing_ ? min_smoothing_len_ : effective_rad_;
+        Real max_h = variable_smoothing_ ? max_smoothing_len_ : effective_rad_;
+        wall->Precompute(kernel_, gkernel_, lkernel_, effective_rad_, min_h, max_h, particle_rad_, num_boundary_layers_, scenario.phases[0].mass);
+        wall_ = wall;
+    }
+
+    // cells of compact snapshot positions
+    glm::ivec2 num_cells = glm::ivec2(glm::ceil((max_boundary_coord_ - min_boundary_coord_) / effective_rad_));
+    quantizer_.Reset(glm::vec2(min_boundary_coord_), float(effective_rad_), num_cells, scenario.phases.size());
 
     // terrain
-    terrain_ = std::make_unique<Terrain>(Flat, min_boundary_coord_, max_boundary_coord_);
+    terrain_ = shared.terrain ? shared.terrain : std::make_shared<Terrain>(scenario.terrain, glm::vec2(min_boundary_coord_), glm::vec2(max_boundary_coord_));
 
     // phase
-    phase_.push_back(kPhaseBoundary);
-    phase_.push_back(kPhaseA);
-    phase_.push_back(kPhaseB);
+    phase_ = scenario.phases;
 
     // initialize
-    GenerateBoundary();
-    GenerateFluid(min_coord_, max_coord_);
+    if(boundary_model_ == kBoundaryParticle) GenerateBoundary();
+    for(const FluidRegion &region: scenario.regions) {
+        real2 min_pos = min_coord_ + real2(region.min_coord) * (max_coord_ - min_coord_);
+        real2 max_pos = min_coord_ + real2(region.max_coord) * (max_coord_ - min_coord_);
+        std::vector<Real> frac(region.frac.begin(), region.frac.end());
+        GenerateFluid(min_pos, max_pos, real2(region.vel), frac);
+    }
     CalcMixture();
     CalcCol();
+    ClearDirtyFractions();
 
     // nearest neighbor
     int n = std::accumulate(num_particles_.begin(), num_particles_.end(), 0);
     neighbor_.resize(n);
-    nn_ = std::make_unique<NearestNeighbor>(min_boundary_coord_, max_boundary_coord_, effective_rad_, n);
-    nn_->Register(pos_);
-    nn_->Search(pos_, &neighbor_, effective_rad_);
+    neighbor_capacity_ = 0;
+    nn_ = std::make_unique<NearestNeighbor<Real>>(min_boundary_coord_, max_boundary_coord_, effective_rad_, n);
+    if(periodic_[0] || periodic_[1]) nn_->SetPeriodic(periodic_, min_coord_, max_coord_, effective_rad_);
+    if(scenario.tune_grid && !variable_smoothing_) {
+        std::vector<Real> ratios = {0.5, 0.6, 0.75, 1.0};
+        nn_->Tune(pos_, num_particles_[kBoundary], n, effective_rad_, ratios, &grid_trials_);
+    } else if(scenario.cell_ratio > 0) {
+        nn_->SetCellWidth(scenario.cell_ratio * effective_rad_);
+    }
+    if(variable_smoothing_) {
+        mnn_ = std::make_unique<MultiLevelNeighbor<Real>>(min_boundary_coord_, max_boundary_coord_, min_smoothing_len_, 4, n);
+        if(periodic_[0] || periodic_[1]) mnn_->SetPeriodic(periodic_, min_coord_, max_coord_);
+    }
+    BuildBoundaryGrid();
+    SearchNeighbors();
 
     // height
     CalcInterpDens();
     CalcHeight();
 
+    // split integrators kick with forces of previous step
+    if(integrator_ == kIntegratorLeapfrog || integrator_ == kIntegratorVerlet) CalcAcc();
+
     // buffers
-    glGenVertexArrays(1, &vao_);
-    glGenBuffers(1, &vbo_);
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, n*(sizeof(glm::vec2) + sizeof(float) + sizeof(glm::vec3)), NULL, GL_DYNAMIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, n*sizeof(glm::vec2), pos_.data());
-    glBufferSubData(GL_ARRAY_BUFFER, n*sizeof(glm::vec2), n*sizeof(float), height_.data());
-    glBufferSubData(GL_ARRAY_BUFFER, n*(sizeof(glm::vec2) + sizeof(float)), n*sizeof(glm::vec3), col_.data());
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(n*sizeof(glm::vec2)));
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(n*(sizeof(glm::vec2) + sizeof(float))));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
+    buffer_updated_ = false;
+    renderer_ = std::make_unique<ParticleRenderer>(glm::vec2(min_boundary_coord_), glm::vec2(max_boundary_coord_), 16);
+
+    // water surface
+    surface_updated_ = false;
+
+    // threads
+    max_threads_ = glm::max(std::thread::hardware_concurrency(), 1u);
+
+    // profiling
+    std::fill(stage_time_, stage_time_ + kNumStages, 0.0);
+
+    // gauges
+    num_steps_ = 0;
+    gauge_interval_ = scenario.gauge_interval;
+    if(!scenario.gauges.empty()) {
+        std::vector<glm::vec2> points;
+        for(const glm::vec2 &gauge: scenario.gauges) {
+            points.push_back(glm::vec2(min_coord_) + gauge * glm::vec2(max_coord_ - min_coord_));
+        }
+        SetGauges(points, scenario.gauge_path);
+    }
 }
 
 /**
  * @brief destructor
  */
-Simulater::~Simulater() {
-    glDeleteBuffers(1, &vbo_);
-    glDeleteVertexArrays(1, &vao_);
+template<typename Real, typename Accum>
+Simulater<Real, Accum>::~Simulater() {
+
 }
 
 /**
  * @brief get delta time
  * @return dt
  */
-float Simulater::GetDeltaTime() {
+template<typename Real, typename Accum>
+Real Simulater<Real, Accum>::GetDeltaTime() {
     return dt_;
 }
 
+/**
+ * @brief get simulated time
+ * @return seconds
+ */
+template<typename Real, typename Accum>
+double Simulater<Real, Accum>::GetTime() const {
+    return num_steps_ * (double)dt_;
+}
+
+/**
+ * @brief get mean energy per unit mass of fluid, kinetic plus potential of water column
+ * @return energy
+ */
+template<typename Real, typename Accum>
+double Simulater<Real, Accum>::GetEnergy() const {
+    double energy = 0.0;
+    double mass = 0.0;
+    for(int i = 0; i < pos_.size(); i++) {
+        if(attr_[i] != kFluid) continue;
+        // center of mass of column lies at half depth above terrain
+        double depth = interp_dens_[i] / dens_[i];
+        double bed = height_[i] - depth;
+        energy += mass_[i] * (0.5 * glm::dot(glm::dvec2(vel_[i]), glm::dvec2(vel_[i])) + kGravityAcceleration * (bed + 0.5 * depth));
+        mass += mass_[i];
+    }
+    return mass > 0.0 ? energy / mass : 0.0;
+}
+
+/**
+ * @brief get number of particles
+ * @param[in] attr attribute
+ * @return number of particles
+ */
+template<typename Real, typename Accum>
+int Simulater<Real, Accum>::GetNumParticles(ParticleAttribute attr) const {
+    return num_particles_[attr];
+}
+
+/**
+ * @brief get positions of particles
+ * @return positions
+ */
+template<typename Real, typename Accum>
+const std::vector<typename Simulater<Real, Accum>::real2> &Simulater<Real, Accum>::GetPositions() const {
+    return pos_;
+}
+
+/**
+ * @brief get interpolated densities of particles
+ * @return interpolated densities
+ */
+template<typename Real, typename Accum>
+const std::vector<Real> &Simulater<Real, Accum>::GetInterpDensities() const {
+    return interp_dens_;
+}
+
+/**
+ * @brief get heights of particles
+ * @return heights
+ */
+template<typename Real, typename Accum>
+const std::vector<Real> &Simulater<Real, Accum>::GetHeights() const {
+    return height_;
+}
+
+/**
+ * @brief get attributes of particles
+ * @return attributes
+ */
+template<typename Real, typename Accum>
+const std::vector<ParticleAttribute> &Simulater<Real, Accum>::GetAttributes() const {
+    return attr_;
+}
+
+/**
+ * @brief get persistent ids of particles
+ * @return ids
+ */
+template<typename Real, typename Accum>
+const std::vector<int> &Simulater<Real, Accum>::GetIds() const {
+    return id_;
+}
+
+/**
+ * @brief sum neighbor contributions in order of particle id
+ * @param[in] deterministic deterministic or not
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SetDeterministic(bool deterministic) {
+    deterministic_ = deterministic;
+}
+
+/**
+ * @brief limit threads of parallel stages, so that concurrent simulaters do not oversubscribe cores
+ * @param[in] max_threads maximum number of threads
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SetMaxThreads(int max_threads) {
+    max_threads_ = glm::max(max_threads, 1);
+    if(pool_ && pool_->GetNumThreads() != max_threads_) pool_.reset();
+}
+
+/**
+ * @brief run only a subdomain and exchange particles with the others
+ * @param[in] transport transport between subdomains
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SetDecomposition(std::unique_ptr<Transport> transport) {
+    // ghosts moved by predictor-corrector need complete densities of their own neighbors, one radius further
+    // variable smoothing lets a radius grow up to its maximum
+    Real radius = variable_smoothing_ ? max_smoothing_len_ : effective_rad_;
+    Real halo_width = (integrator_ == kIntegratorPredictorCorrector ? 3 : 2) * radius;
+    decomposition_ = std::make_unique<Decomposition>(glm::vec2(nn_->GetOrigin()), nn_->GetCellWidth()[0], nn_->GetNumCells()[0], halo_width, std::move(transport));
+
+    // boundary particles never move, so keep the ones around this subdomain
+    int rank = decomposition_->GetRank();
+    bool *removed = arena_.Allocate<bool>(pos_.size(), false);
+    for(int i = 0; i < pos_.size(); i++) {
+        if(attr_[i] == kBoundary) {
+            removed[i] = !decomposition_->IsInside(glm::vec2(pos_[i]), halo_width);
+        } else {
+            removed[i] = decomposition_->FindOwner(glm::vec2(pos_[i])) != rank;
+        }
+    }
+    RemoveParticles(removed);
+    BuildBoundaryGrid();
+
+    // each subdomain logs the gauges it owns to its own file, ghosts complete their neighborhoods
+    if(gauges_) {
+        std::vector<glm::vec2> points;
+        for(const glm::vec2 &p: gauges_->GetPoints()) {
+            if(decomposition_->FindOwner(p) == rank) points.push_back(p);
+        }
+        // gauges.bin becomes gauges.1.bin on rank 1
+        std::string path = gauges_->GetPath();
+        size_t dot = path.rfind('.');
+        size_t slash = path.rfind('/');
+        if(dot == std::string::npos || (slash != std::string::npos && slash > dot)) dot = path.size();
+        path.insert(dot, "." + std::to_string(rank));
+        gauges_.reset();
+        if(!points.empty()) SetGauges(points, path);
+    }
+}
+
 /**
  * @brief time evolution
  */
-void Simulater::Evolve() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Evolve() {
+    auto tic = std::chrono::steady_clock::now();
+    std::fill(stage_time_, stage_time_ + kNumStages, 0.0);
+    arena_.Reset();
+    // split integrators move particles before exchange, so that ghosts are sent at drifted positions
+    bool split = integrator_ == kIntegratorLeapfrog || integrator_ == kIntegratorVerlet;
+    if(split) Drift();
+    Lap(kStageIntegrate, &tic);
+    // before exchange so that new particles end up next to the other fluid ones
+    if(adaptive_) Refine();
+    Lap(kStageRefine, &tic);
+    if(decomposition_) Exchange();
+    Lap(kStageExchange, &tic);
     CalcMixture();
-    nn_->Register(pos_);
-    nn_->Search(pos_, &neighbor_, effective_rad_);
+    Lap(kStageMixture, &tic);
+    if(split) PredictVelocity();
+    Lap(kStageIntegrate, &tic);
+    SearchNeighbors();
+    Lap(kStageNeighbor, &tic);
+    // grid was just registered, so gauges see the positions forces are evaluated at
+    if(gauges_ && num_steps_ % gauge_interval_ == 0) SampleGauges();
+    Lap(kStageGauge, &tic);
+    WakeParticles();
+    Lap(kStageWake, &tic);
     CalcInterpDens();
+    Lap(kStageInterpDens, &tic);
     CalcAcc();
+    Lap(kStageAcc, &tic);
+    // counted at positions the grid was registered at, where ghosts are still current, applied after the step
+    Real *smoothing_len = variable_smoothing_ ? arena_.Allocate<Real>(pos_.size()) : nullptr;
+    if(variable_smoothing_) UpdateSmoothingLength(smoothing_len);
+    Lap(kStageSmoothing, &tic);
     Integrate();
+    Lap(kStageIntegrate, &tic);
+    if(implicit_viscosity_) SolveViscosity();
+    Lap(kStageViscosity, &tic);
     CalcHeight();
+    Lap(kStageHeight, &tic);
     CalcCol();
-    UpdateBuffer();
+    ClearDirtyFractions();
+    Lap(kStageColor, &tic);
+    if(variable_smoothing_) std::copy(smoothing_len, smoothing_len + pos_.size(), smoothing_len_.begin());
+    Lap(kStageSmoothing, &tic);
+    if(compact_state_) Quantize();
+    Lap(kStageQuantize, &tic);
+    num_steps_++;
+    buffer_updated_ = false;
+    surface_updated_ = false;
 }
 
 /**
- * @brief draw particles
+ * @brief collect timings of last step, neighbor counts, grid occupancy and memory
+ * @param[out] stats statistics
  */
-void Simulater::DrawParticles() {
-    glBindVertexArray(vao_);
-    glDrawArrays(GL_POINTS, 0, num_particles_[kBoundary]);
-    glDrawArrays(GL_POINTS, num_particles_[kBoundary], num_particles_[kFluid]);
-    glBindVertexArray(0);
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::GetStatistics(Statistics *stats) const {
+    std::copy(stage_time_, stage_time_ + kNumStages, stats->stage_time);
+    for(int a = 0; a < kNumAttributes; a++) stats->num_particles[a] = num_particles_[a];
+
+    // histogram of neighbor counts of fluid particles
+    int nb = num_particles_[kBoundary];
+    int nf = num_particles_[kFluid];
+    int num_bins = 16;
+    long long sum = 0;
+    stats->max_neighbors = 0;
+    for(int i = nb; i < nb + nf; i++) {
+        stats->max_neighbors = glm::max(stats->max_neighbors, (int)neighbor_[i].size());
+        sum += neighbor_[i].size();
+    }
+    stats->avg_neighbors = nf > 0 ? (float)sum / nf : 0.0f;
+    stats->neighbor_bin = stats->max_neighbors / num_bins + 1;
+    stats->neighbor_hist.assign(num_bins, 0);
+    for(int i = nb; i < nb + nf; i++) stats->neighbor_hist[neighbor_[i].size() / stats->neighbor_bin]++;
+
+    // cells of fluid grids
+    stats->num_occupied_cells = 0;
+    stats->num_cells = 0;
+    if(variable_smoothing_) {
+        for(int l = 0; l < mnn_->GetNumLevels(); l++) {
+            stats->num_occupied_cells += mnn_->GetGrid(l).GetNumOccupiedCells();
+            stats->num_cells += mnn_->GetGrid(l).GetNumCells()[0] * mnn_->GetGrid(l).GetNumCells()[1];
+        }
+    } else {
+        stats->num_occupied_cells = nn_->GetNumOccupiedCells();
+        stats->num_cells = nn_->GetNumCells()[0] * nn_->GetNumCells()[1];
+    }
+
+    // memory per subsystem
+    size_t particles = GetMemoryUsage(pos_) + GetMemoryUsage(vel_) + GetMemoryUsage(acc_) + GetMemoryUsage(col_)
+                     + GetMemoryUsage(mass_) + GetMemoryUsage(visc_) + GetMemoryUsage(dens_) + GetMemoryUsage(interp_dens_)
+                     + GetMemoryUsage(frac_) + GetMemoryUsage(frac_dirty_) + GetMemoryUsage(height_) + GetMemoryUsage(attr_)
+                     + GetMemoryUsage(calm_steps_) + GetMemoryUsage(id_) + GetMemoryUsage(mass_scale_) + GetMemoryUsage(smoothing_len_)
+                     + GetMemoryUsage(boundary_dens_) + GetMemoryUsage(wall_dist_) + GetMemoryUsage(wall_grad_) + GetMemoryUsage(wall_lap_)
+                     + GetMemoryUsage(pos_start_) + GetMemoryUsage(vel_start_) + GetMemoryUsage(acc_start_);
+    size_t neighbors = GetMemoryUsage(neighbor_);
+    for(const std::vector<int> &neighbor: neighbor_) neighbors += GetMemoryUsage(neighbor);
+    size_t grids = nn_->GetMemoryUsage() + (boundary_nn_ ? boundary_nn_->GetMemoryUsage() : 0) + (mnn_ ? mnn_->GetMemoryUsage() : 0);
+    size_t buffers = GetMemoryUsage(buffer_pos_) + GetMemoryUsage(buffer_height_) + renderer_->GetMemoryUsage();
+    stats->memory = {{"particles", particles}, {"neighbor lists", neighbors}, {"grids", grids}, {"render buffers", buffers}, {"surface", surface_ ? surface_->GetMemoryUsage() : 0}};
+}
+
+/**
+ * @brief get cost of cell widths tried at startup
+ * @return trials, empty unless grid was tuned
+ */
+template<typename Real, typename Accum>
+const std::vector<GridTrial> &Simulater<Real, Accum>::GetGridTrials() const {
+    return grid_trials_;
+}
+
+/**
+ * @brief get cell width of fluid grid
+ * @return cell width
+ */
+template<typename Real, typename Accum>
+Real Simulater<Real, Accum>::GetCellWidth() const {
+    return nn_->GetCellWidth()[0];
+}
+
+/**
+ * @brief get effective radius of kernel
+ * @return effective radius
+ */
+template<typename Real, typename Accum>
+Real Simulater<Real, Accum>::GetEffectiveRadius() const {
+    return effective_rad_;
+}
+
+/**
+ * @brief get number of conjugate gradient iterations of last viscosity solve
+ * @return iterations
+ */
+template<typename Real, typename Accum>
+int Simulater<Real, Accum>::GetViscosityIterations() const {
+    return viscosity_iterations_;
+}
+
+/**
+ * @brief get wall tables and terrain to share with other simulaters of the same domain
+ * @return shared data
+ */
+template<typename Real, typename Accum>
+SharedData<Real> Simulater<Real, Accum>::GetSharedData() const {
+    SharedData<Real> shared;
+    shared.wall = wall_;
+    shared.terrain = terrain_;
+    return shared;
+}
+
+/**
+ * @brief get renderer of particles
+ * @return renderer
+ */
+template<typename Real, typename Accum>
+ParticleRenderer *Simulater<Real, Accum>::GetParticleRenderer() {
+    return renderer_.get();
+}
+
+/**
+ * @brief draw particles in grid cells inside frustum
+ * @param[in] frustum planes of view frustum
+ * @param[in] eye position of camera
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::DrawParticles(const std::array<glm::vec4, 6> &frustum, const glm::vec3 &eye) {
+    UpdateBuffer();
+    renderer_->Draw(frustum, eye);
 }
 
 /**
  * @brief draw terrain
  */
-void Simulater::DrawTerrain() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::DrawTerrain() {
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     terrain_->Draw();
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
 
+/**
+ * @brief draw water surface
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::DrawSurface() {
+    UpdateSurface();
+    surface_->Draw();
+}
+
 /**
  * @brief add particle
  * @param[in] pos position
@@ -136,11 +544,12 @@ void Simulater::DrawTerrain() {
  * @param[in] visc kinematic viscosity
  * @param[in] dens density
  * @param[in] interp_dens interpolated density
- * @param[in] frac fractuation
+ * @param[in] frac nonzero fractions
  * @param[in] height height
  * @param[in] attr attribute
  */
-void Simulater::AddParticle(const glm::vec2 &pos, const glm::vec2 &vel, const glm::vec2 &acc, const glm::vec3 &col, float mass, float visc, float dens, float interp_dens, const std::vector<float> &frac, float height, ParticleAttribute attr) {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::AddParticle(const real2 &pos, const real2 &vel, const real2 &acc, const glm::vec3 &col, Real mass, Real visc, Real dens, Real interp_dens, const fraction &frac, Real height, ParticleAttribute attr) {
     pos_.push_back(pos);
     vel_.push_back(vel);
     acc_.push_back(acc);
@@ -150,34 +559,45 @@ void Simulater::AddParticle(const glm::vec2 &pos, const glm::vec2 &vel, const gl
     dens_.push_back(dens);
     interp_dens_.push_back(interp_dens);
     frac_.push_back(frac);
+    frac_dirty_.push_back(true);
     height_.push_back(height);
     attr_.push_back(attr);
+    calm_steps_.push_back(0);
+    id_.push_back(next_id_++);
+    mass_scale_.push_back(1);
+    smoothing_len_.push_back(effective_rad_);
     num_particles_[attr]++;
 }
 
 /**
  * @brief generate boundary particle
  */
-void Simulater::GenerateBoundary() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::GenerateBoundary() {
+    const Phase &phase = phase_[0];
+    fraction frac;
+    frac.count = 1;
+    frac.phase[0] = 0;
+    frac.frac[0] = 1;
     for(int l = 0; l < num_boundary_layers_; l++) {
-        glm::vec2 len = max_coord_ - min_coord_ + 4 * l * particle_rad_;
+        real2 len = max_coord_ - min_coord_ + 4 * l * particle_rad_;
         glm::ivec2 n = glm::ivec2(glm::ceil(len / (2 * particle_rad_))) + 2;
-        glm::vec2 d = (len + 2 * particle_rad_) / glm::vec2(n-1);
+        real2 d = (len + 2 * particle_rad_) / real2(n-1);
 
         // along x-axis
-        glm::vec2 min_pos = min_coord_ - (2*l+1) * particle_rad_;
-        glm::vec2 max_pos = max_coord_ + (2*l+1) * particle_rad_;
+        real2 min_pos = min_coord_ - (2*l+1) * particle_rad_;
+        real2 max_pos = max_coord_ + (2*l+1) * particle_rad_;
         for(int xi = 0; xi < n[0]; xi++) {
-            AddParticle(min_pos, glm::vec2(0.0f), glm::vec2(0.0f), kPhaseBoundary.col, kPhaseBoundary.mass, kPhaseBoundary.visc, kPhaseBoundary.dens, kPhaseBoundary.dens, std::vector<float>({1.0f, 0.0f, 0.0f}), 1.0f + terrain_->GetHeight(min_pos), kBoundary);
-            AddParticle(max_pos, glm::vec2(0.0f), glm::vec2(0.0f), kPhaseBoundary.col, kPhaseBoundary.mass, kPhaseBoundary.visc, kPhaseBoundary.dens, kPhaseBoundary.dens, std::vector<float>({1.0f, 0.0f, 0.0f}), 1.0f + terrain_->GetHeight(max_pos), kBoundary);
+            AddParticle(min_pos, real2(0), real2(0), phase.col, phase.mass, phase.visc, phase.dens, phase.dens, frac, 1.0f + terrain_->GetHeight(glm::vec2(min_pos)), kBoundary);
+            AddParticle(max_pos, real2(0), real2(0), phase.col, phase.mass, phase.visc, phase.dens, phase.dens, frac, 1.0f + terrain_->GetHeight(glm::vec2(max_pos)), kBoundary);
             min_pos[0] += d[0];
             max_pos[0] -= d[0];
         }
 
         // along z-axis
         for(int zi = 0; zi < n[1]; zi++) {
-            AddParticle(min_pos, glm::vec2(0.0f), glm::vec2(0.0f), kPhaseBoundary.col, kPhaseBoundary.mass, kPhaseBoundary.visc, kPhaseBoundary.dens, kPhaseBoundary.dens, std::vector<float>({1.0f, 0.0f, 0.0f}), 1.0f + terrain_->GetHeight(min_pos), kBoundary);
-            AddParticle(max_pos, glm::vec2(0.0f), glm::vec2(0.0f), kPhaseBoundary.col, kPhaseBoundary.mass, kPhaseBoundary.visc, kPhaseBoundary.dens, kPhaseBoundary.dens, std::vector<float>({1.0f, 0.0f, 0.0f}), 1.0f + terrain_->GetHeight(max_pos), kBoundary);
+            AddParticle(min_pos, real2(0), real2(0), phase.col, phase.mass, phase.visc, phase.dens, phase.dens, frac, 1.0f + terrain_->GetHeight(glm::vec2(min_pos)), kBoundary);
+            AddParticle(max_pos, real2(0), real2(0), phase.col, phase.mass, phase.visc, phase.dens, phase.dens, frac, 1.0f + terrain_->GetHeight(glm::vec2(max_pos)), kBoundary);
             min_pos[1] += d[1];
             max_pos[1] -= d[1];
         }
@@ -188,60 +608,640 @@ void Simulater::GenerateBoundary() {
  * @brief generate fluid
  * @param[in] min_pos minimum position
  * @param[in] max_pos maximum position
+ * @param[in] vel initial velocity
+ * @param[in] frac volume fractions
  */
-void Simulater::GenerateFluid(const glm::vec2 &min_pos, const glm::vec2 &max_pos) {
-    glm::vec2 size = max_pos - min_pos;
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::GenerateFluid(const real2 &min_pos, const real2 &max_pos, const real2 &vel, const std::vector<Real> &frac) {
+    real2 size = max_pos - min_pos;
     glm::ivec2 n = glm::ivec2(glm::floor(size / (2*particle_rad_)));
-    glm::vec2 center = min_pos + size / 2.0f;
-    glm::vec2 min_r = center - glm::vec2(n) * particle_rad_ + particle_rad_;
-    glm::vec2 max_r = center + glm::vec2(n) * particle_rad_ - particle_rad_;
+    real2 center = min_pos + size / Real(2);
+    real2 min_r = center - real2(n) * particle_rad_ + particle_rad_;
+    fraction sparse;
+    Compress(frac.data(), nullptr, frac.size(), &sparse);
 
-    for(float x = min_r[0]; x <= max_r[0]; x += 2*particle_rad_) {
-        for(float z = min_r[1]; z <= max_r[1]; z += 2*particle_rad_) {
-            glm::vec2 pos = glm::vec2(x, z);
-            AddParticle(pos, glm::vec2(0.5f), glm::vec2(0.0f), kPhaseA.col, kPhaseA.mass, kPhaseA.visc, kPhaseA.dens, kPhaseA.dens, std::vector<float>({0.0f, 0.5f, 0.5f}), 1.0f + terrain_->GetHeight(pos), kFluid);
+    // count steps so that every precision generates the same lattice
+    for(int xi = 0; xi < n[0]; xi++) {
+        for(int zi = 0; zi < n[1]; zi++) {
+            real2 pos = min_r + real2(xi, zi) * (2*particle_rad_);
+            if(wall_->Distance(pos) < Real(0.5) * particle_rad_) continue;
+            AddParticle(pos, vel, real2(0), glm::vec3(0.0f), 0, 0, 0, 0, sparse, 1.0f + terrain_->GetHeight(glm::vec2(pos)), kFluid);
         }
     }
 }
 
 /**
- * @brief calculate color
+ * @brief remove particles keeping order of the rest
+ * @param[in] removed flags of particles to be removed
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::RemoveParticles(const bool *removed) {
+    int n = 0;
+    std::fill(num_particles_.begin(), num_particles_.end(), 0);
+    for(int i = 0; i < pos_.size(); i++) {
+        if(removed[i]) continue;
+        pos_[n] = pos_[i];
+        vel_[n] = vel_[i];
+        acc_[n] = acc_[i];
+        col_[n] = col_[i];
+        mass_[n] = mass_[i];
+        visc_[n] = visc_[i];
+        dens_[n] = dens_[i];
+        interp_dens_[n] = interp_dens_[i];
+        frac_[n] = frac_[i];
+        frac_dirty_[n] = frac_dirty_[i];
+        height_[n] = height_[i];
+        attr_[n] = attr_[i];
+        calm_steps_[n] = calm_steps_[i];
+        mass_scale_[n] = mass_scale_[i];
+        smoothing_len_[n] = smoothing_len_[i];
+        id_[n] = id_[i];
+        num_particles_[attr_[n]]++;
+        n++;
+    }
+    pos_.resize(n);
+    vel_.resize(n);
+    acc_.resize(n);
+    col_.resize(n);
+    mass_.resize(n);
+    visc_.resize(n);
+    dens_.resize(n);
+    interp_dens_.resize(n);
+    frac_.resize(n);
+    frac_dirty_.resize(n);
+    height_.resize(n);
+    attr_.resize(n);
+    calm_steps_.resize(n);
+    mass_scale_.resize(n);
+    smoothing_len_.resize(n);
+    id_.resize(n);
+}
+
+/**
+ * @brief migrate particles to adjacent subdomains and exchange halo particles
  */
-void Simulater::CalcCol() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Exchange() {
+    int rank = decomposition_->GetRank();
+    int size = decomposition_->GetNumSubdomains();
+    std::vector<int> neighbors = decomposition_->GetNeighbors();
+
+    std::vector<std::vector<char>> migrants(size), ghosts(size);
+    std::vector<int> num_migrants(size, 0), num_ghosts(size, 0);
+    std::vector<char> local_ghosts;
+    int num_local_ghosts = 0;
+
+    // previous ghosts are dropped, leaving particles are kept here as ghosts
+    bool *removed = arena_.Allocate<bool>(pos_.size(), false);
     for(int i = 0; i < pos_.size(); i++) {
+        if(attr_[i] == kGhost) {
+            removed[i] = true;
+            continue;
+        }
+        if(attr_[i] != kFluid) continue;
+
+        int dst = decomposition_->FindDestination(glm::vec2(pos_[i]));
+        if(dst != rank) {
+            PackParticle(i, &migrants[dst]);
+            num_migrants[dst]++;
+            PackParticle(i, &local_ghosts);
+            num_local_ghosts++;
+            removed[i] = true;
+            continue;
+        }
+        for(int n: neighbors) {
+            if(decomposition_->IsInHalo(glm::vec2(pos_[i]), n)) {
+                PackParticle(i, &ghosts[n]);
+                num_ghosts[n]++;
+            }
+        }
+    }
+    RemoveParticles(removed);
+
+    std::vector<std::vector<char>> send(size), recv;
+    for(int n: neighbors) {
+        Pack(num_migrants[n], &send[n]);
+        send[n].insert(send[n].end(), migrants[n].begin(), migrants[n].end());
+        Pack(num_ghosts[n], &send[n]);
+        send[n].insert(send[n].end(), ghosts[n].begin(), ghosts[n].end());
+    }
+    decomposition_->Exchange(send, &recv);
+
+    // fluid particles first so that each attribute stays contiguous, rest of a malformed message is dropped
+    std::vector<size_t> offsets(size, 0);
+    std::vector<bool> valid(size, true);
+    for(int n: neighbors) {
+        valid[n] = CanUnpack<int>(recv[n], offsets[n]);
+        int m = valid[n] ? Unpack<int>(recv[n], &offsets[n]) : 0;
+        for(int k = 0; k < m && valid[n]; k++) valid[n] = UnpackParticle(recv[n], &offsets[n], kFluid);
+    }
+    size_t offset = 0;
+    for(int k = 0; k < num_local_ghosts; k++) UnpackParticle(local_ghosts, &offset, kGhost);
+    for(int n: neighbors) {
+        valid[n] = valid[n] && CanUnpack<int>(recv[n], offsets[n]);
+        int g = valid[n] ? Unpack<int>(recv[n], &offsets[n]) : 0;
+        for(int k = 0; k < g && valid[n]; k++) valid[n] = UnpackParticle(recv[n], &offsets[n], kGhost);
+        if(!valid[n]) std::cerr << "Malformed message from subdomain " << n << std::endl;
+    }
+}
+
+/**
+ * @brief pack moving particles into compact snapshot in order of cells, boundary particles never move and are left out
+ * @param[out] state compact snapshot
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Compact(CompactParticles *state) const {
+    *state = quantizer_;
+    int nb = num_particles_[kBoundary];
+    std::vector<int> cell(pos_.size());
+    std::vector<int> order(pos_.size() - nb);
+    for(int i = nb; i < pos_.size(); i++) cell[i] = quantizer_.GetCell(glm::vec2(pos_[i]));
+    std::iota(order.begin(), order.end(), nb);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return cell[a] < cell[b]; });
+
+    CompactParticles::fraction frac;
+    for(int i: order) {
+        frac.count = frac_[i].count;
+        for(int k = 0; k < frac.count; k++) {
+            frac.phase[k] = frac_[i].phase[k];
+            frac.frac[k] = float(frac_[i].frac[k]);
+        }
+        state->Add(glm::vec2(pos_[i]), glm::vec2(vel_[i]), frac, float(mass_scale_[i]), float(smoothing_len_[i]), id_[i], attr_[i], calm_steps_[i]);
+    }
+}
+
+/**
+ * @brief replace moving particles by those of compact snapshot and derive the other quantities
+ * @details boundary particles of the same scene are kept as they are, so they are not rounded
+ * @param[in] state compact snapshot
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Expand(const CompactParticles &state) {
+    bool *removed = arena_.Allocate<bool>(pos_.size(), false);
+    for(int i = 0; i < pos_.size(); i++) removed[i] = attr_[i] != kBoundary;
+    RemoveParticles(removed);
+
+    // attributes stay contiguous, cell order within each
+    glm::vec2 pos, vel;
+    CompactParticles::fraction frac;
+    fraction sparse;
+    float mass_scale, smoothing_len;
+    int id, attr, calm_steps;
+    for(int a = kBoundary + 1; a < kNumAttributes; a++) {
+        for(int k = 0; k < state.GetNumParticles(); k++) {
+            state.Get(k, &pos, &vel, &frac, &mass_scale, &smoothing_len, &id, &attr, &calm_steps);
+            if(attr != a) continue;
+            sparse.count = frac.count;
+            for(int p = 0; p < frac.count; p++) {
+                sparse.phase[p] = frac.phase[p];
+                sparse.frac[p] = frac.frac[p];
+            }
+            AddParticle(real2(pos), real2(vel), real2(0), glm::vec3(0.0f), 0, 0, 0, 0, sparse, 0, (ParticleAttribute)attr);
+            id_.back() = id;
+            mass_scale_.back() = mass_scale;
+            smoothing_len_.back() = smoothing_len;
+            calm_steps_.back() = calm_steps;
+            next_id_ = glm::max(next_id_, id + 1);
+        }
+    }
+
+    BuildBoundaryGrid();
+    CalcMixture();
+    CalcCol();
+    ClearDirtyFractions();
+    SearchNeighbors();
+    CalcInterpDens();
+    CalcHeight();
+    if(integrator_ == kIntegratorLeapfrog || integrator_ == kIntegratorVerlet) CalcAcc();
+    buffer_updated_ = false;
+    surface_updated_ = false;
+}
+
+/**
+ * @brief round state of moving particles to what compact snapshot can represent, to measure accuracy snapshots cost
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Quantize() {
+    auto round_half = [](Real x) { return Real(HalfToFloat(FloatToHalf(float(x)))); };
+    for(int i = 0; i < pos_.size(); i++) {
+        if(attr_[i] == kBoundary) continue;
+        pos_[i] = real2(quantizer_.RoundPosition(glm::vec2(pos_[i])));
+        vel_[i] = real2(round_half(vel_[i][0]), round_half(vel_[i][1]));
+        smoothing_len_[i] = round_half(smoothing_len_[i]);
+
+        // fractions normalized after rounding, those rounded to zero dropped, mixture only recomputed when they changed
+        fraction &frac = frac_[i];
+        int phase[kMaxPhasesPerParticle];
+        Real rounded[kMaxPhasesPerParticle];
+        Real sum = 0;
+        for(int k = 0; k < frac.count; k++) sum += CompactParticles::EncodeFraction(float(frac.frac[k]));
+        bool changed = false;
+        for(int k = 0; k < frac.count; k++) {
+            phase[k] = frac.phase[k];
+            rounded[k] = CompactParticles::EncodeFraction(float(frac.frac[k])) / sum;
+            changed = changed || rounded[k] != frac.frac[k];
+        }
+        if(!changed) continue;
+        Compress(rounded, phase, frac.count, &frac);
+        frac_dirty_[i] = true;
+    }
+}
+
+/**
+ * @brief serialize particle
+ * @param[in] i particle index
+ * @param[out] buf message
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::PackParticle(int i, std::vector<char> *buf) const {
+    Pack(pos_[i], buf);
+    Pack(vel_[i], buf);
+    Pack(acc_[i], buf);
+    Pack(height_[i], buf);
+    Pack(id_[i], buf);
+    Pack(mass_scale_[i], buf);
+    Pack(smoothing_len_[i], buf);
+    Pack(calm_steps_[i], buf);
+    Pack(frac_[i].count, buf);
+    for(int k = 0; k < frac_[i].count; k++) {
+        Pack(frac_[i].phase[k], buf);
+        Pack(frac_[i].frac[k], buf);
+    }
+}
+
+/**
+ * @brief deserialize particle and add it
+ * @param[in] buf message
+ * @param[in,out] offset read position
+ * @param[in] attr attribute
+ * @return succeeded or not, fails on truncated message and on fractions this simulater cannot hold
+ */
+template<typename Real, typename Accum>
+bool Simulater<Real, Accum>::UnpackParticle(const std::vector<char> &buf, size_t *offset, ParticleAttribute attr) {
+    if(!CanUnpack<char>(buf, *offset, 3 * sizeof(real2) + 3 * sizeof(Real) + 3 * sizeof(int))) return false;
+    real2 pos = Unpack<real2>(buf, offset);
+    real2 vel = Unpack<real2>(buf, offset);
+    real2 acc = Unpack<real2>(buf, offset);
+    Real height = Unpack<Real>(buf, offset);
+    int id = Unpack<int>(buf, offset);
+    Real mass_scale = Unpack<Real>(buf, offset);
+    Real smoothing_len = Unpack<Real>(buf, offset);
+    int calm_steps = Unpack<int>(buf, offset);
+    fraction frac;
+    frac.count = Unpack<int>(buf, offset);
+    if(frac.count < 0 || frac.count > kMaxPhasesPerParticle) return false;
+    if(!CanUnpack<char>(buf, *offset, frac.count * (sizeof(int) + sizeof(Real)))) return false;
+    for(int k = 0; k < frac.count; k++) {
+        frac.phase[k] = Unpack<int>(buf, offset);
+        frac.frac[k] = Unpack<Real>(buf, offset);
+        if(frac.phase[k] < 0 || frac.phase[k] >= int(phase_.size())) return false;
+    }
+    AddParticle(pos, vel, acc, glm::vec3(0.0f), 0.0f, 0.0f, 0.0f, 0.0f, frac, height, attr);
+    id_.back() = id;
+    mass_scale_.back() = mass_scale;
+    smoothing_len_.back() = smoothing_len;
+    calm_steps_.back() = calm_steps;
+    return true;
+}
+
+/**
+ * @brief register static boundary particles on their own grid
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::BuildBoundaryGrid() {
+    int nb = num_particles_[kBoundary];
+    boundary_nn_ = std::make_unique<NearestNeighbor<Real>>(min_boundary_coord_, max_boundary_coord_, effective_rad_, nb);
+    boundary_nn_->Register(pos_, 0, nb);
+
+    // boundary-boundary part of interpolated density never changes
+    boundary_dens_.assign(nb, 0);
+    std::vector<int> neighbors;
+    for(int i = 0; i < nb; i++) {
+        neighbors.clear();
+        boundary_nn_->Search(pos_[i], pos_, &neighbors, effective_rad_);
+        for(int j: neighbors) {
+            Real r = glm::length(pos_[i] - pos_[j]);
+            boundary_dens_[i] += mass_[j] * kernel_(r, effective_rad_);
+        }
+    }
+}
+
+/**
+ * @brief search neighbors of moving particles in moving and boundary grids
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SearchNeighbors() {
+    int nb = num_particles_[kBoundary];
+    if(variable_smoothing_) {
+        mnn_->Register(pos_, smoothing_len_, nb, pos_.size());
+    } else {
+        nn_->Register(pos_, nb, pos_.size());
+    }
+    // lists of removed particles are kept for new ones
+    if(neighbor_.size() < pos_.size()) neighbor_.resize(pos_.size());
+    int max_neighbors = 0;
+    for(int i = nb; i < pos_.size(); i++) {
+        // lists share a capacity with headroom so that they stop growing once the flow settles
+        neighbor_[i].clear();
+        if(neighbor_[i].capacity() < neighbor_capacity_) neighbor_[i].reserve(neighbor_capacity_);
+        if(variable_smoothing_) {
+            mnn_->Search(pos_[i], smoothing_len_[i], pos_, &neighbor_[i]);
+        } else {
+            nn_->Search(pos_[i], pos_, &neighbor_[i], effective_rad_);
+        }
+        // boundary particles keep the initial smoothing length
+        boundary_nn_->Search(pos_[i], pos_, &neighbor_[i], (smoothing_len_[i] + effective_rad_) / 2);
+        if(deterministic_) {
+            std::sort(neighbor_[i].begin(), neighbor_[i].end(), [&](int a, int b) { return id_[a] < id_[b]; });
+        }
+        max_neighbors = glm::max(max_neighbors, (int)neighbor_[i].size());
+    }
+    if(max_neighbors > neighbor_capacity_) neighbor_capacity_ = max_neighbors + max_neighbors / 4;
+}
+
+/**
+ * @brief wake sleeping particles approached by moving ones
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::WakeParticles() {
+    for(int i = num_particles_[kBoundary]; i < pos_.size(); i++) {
+        if(IsAsleep(i) || glm::length(vel_[i]) < sleep_vel_) continue;
+        for(int j: neighbor_[i]) {
+            if(IsAsleep(j)) calm_steps_[j] = 0;
+        }
+    }
+}
+
+/**
+ * @brief check particle is sleeping
+ * @param[in] i particle index
+ * @return sleeping or not
+ */
+template<typename Real, typename Accum>
+bool Simulater<Real, Accum>::IsAsleep(int i) const {
+    return calm_steps_[i] >= sleep_steps_;
+}
+
+/**
+ * @brief split particles near shorelines and phase interfaces, merge them in deep calm water
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Refine() {
+    int n = pos_.size();
+    bool *removed = arena_.Allocate<bool>(n, false);
+    bool *merged = arena_.Allocate<bool>(n, false);
+    for(int i = 0; i < n; i++) {
+        if(attr_[i] != kFluid || removed[i] || merged[i]) continue;
+
+        // shallow water covers shorelines and wet fronts, fraction jump covers interfaces
+        Real depth = interp_dens_[i] / dens_[i];
+        Real jump = 0;
+        for(int j: neighbor_[i]) {
+            if(attr_[j] == kBoundary) continue;
+            jump = glm::max(jump, CalcFractionJump(frac_[i], frac_[j]));
+        }
+        if(depth < split_depth_ || jump > split_frac_) {
+            if(mass_scale_[i] / 4 >= min_mass_scale_ && SplitParticle(i)) removed[i] = true;
+            continue;
+        }
+        if(mass_scale_[i] >= 1 || depth < merge_depth_ || glm::length(vel_[i]) > merge_vel_) continue;
+
+        // nearest calm partner of the same resolution
+        int partner = -1;
+        Real min_dist = std::numeric_limits<Real>::max();
+        for(int j: neighbor_[i]) {
+            if(j == i || attr_[j] != kFluid || removed[j] || merged[j]) continue;
+            if(mass_scale_[j] != mass_scale_[i] || interp_dens_[j] / dens_[j] < merge_depth_ || glm::length(vel_[j]) > merge_vel_) continue;
+            Real dist = glm::length(MinimumImage(pos_[i] - pos_[j], periodic_, period_));
+            if(dist < min_dist) {
+                min_dist = dist;
+                partner = j;
+            }
+        }
+        if(partner < 0) continue;
+        MergeParticles(i, partner);
+        merged[i] = true;
+        removed[partner] = true;
+    }
+    // children appended by splits are kept
+    bool *all_removed = arena_.Allocate<bool>(pos_.size(), false);
+    std::copy(removed, removed + n, all_removed);
+    RemoveParticles(all_removed);
+}
+
+/**
+ * @brief add four children of a particle on a finer lattice
+ * @param[in] i particle index
+ * @return split or not
+ */
+template<typename Real, typename Accum>
+bool Simulater<Real, Accum>::SplitParticle(int i) {
+    real2 pos = pos_[i];
+    Real a = Real(0.5) * particle_rad_ * std::sqrt(mass_scale_[i]);
+    real2 children[4] = {pos + real2(-a, -a), pos + real2(a, -a), pos + real2(-a, a), pos + real2(a, a)};
+    for(const real2 &child: children) {
+        if(wall_->Distance(child) < 0) return false;
+    }
+
+    // same velocity and fractions conserve momentum and mass of each phase
+    real2 vel = vel_[i];
+    real2 acc = acc_[i];
+    glm::vec3 col = col_[i];
+    Real interp_dens = interp_dens_[i];
+    fraction frac = frac_[i];
+    Real height = height_[i];
+    Real mass_scale = mass_scale_[i] / 4;
+    Real smoothing_len = variable_smoothing_ ? glm::max(smoothing_len_[i] / 2, min_smoothing_len_) : effective_rad_;
+    bool periodic = periodic_[0] || periodic_[1];
+    for(const real2 &child: children) {
+        AddParticle(child, vel, acc, col, 0, 0, 0, interp_dens, frac, height, kFluid);
+        mass_scale_.back() = mass_scale;
+        smoothing_len_.back() = smoothing_len;
+        // children past a periodic side enter on the other
+        if(periodic) Collide(pos_.size() - 1);
+    }
+    return true;
+}
+
+/**
+ * @brief merge particle j into particle i
+ * @param[in] i particle index to keep
+ * @param[in] j particle index to be removed
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::MergeParticles(int i, int j) {
+    Real m_i = mass_[i];
+    Real m_j = mass_[j];
+    // nearest image of partner, mass center wrapped back into domain
+    bool periodic = periodic_[0] || periodic_[1];
+    real2 pos_j = periodic ? pos_[i] - MinimumImage(pos_[i] - pos_[j], periodic_, period_) : pos_[j];
+    pos_[i] = (m_i * pos_[i] + m_j * pos_j) / (m_i + m_j);
+    if(periodic) Collide(i);
+    vel_[i] = (m_i * vel_[i] + m_j * vel_[j]) / (m_i + m_j);
+    acc_[i] = (m_i * acc_[i] + m_j * acc_[j]) / (m_i + m_j);
+
+    // fractions weighted by volume keep mass of each phase, union of both phases merged by order
+    Real s_i = mass_scale_[i];
+    Real s_j = mass_scale_[j];
+    const fraction &a = frac_[i];
+    const fraction &b = frac_[j];
+    int phase[2*kMaxPhasesPerParticle];
+    Real frac[2*kMaxPhasesPerParticle];
+    int count = 0;
+    for(int p = 0, q = 0; p < a.count || q < b.count; count++) {
+        bool take_a = p < a.count && (q == b.count || a.phase[p] <= b.phase[q]);
+        bool take_b = q < b.count && (p == a.count || b.phase[q] <= a.phase[p]);
+        phase[count] = take_a ? a.phase[p] : b.phase[q];
+        frac[count] = (s_i * (take_a ? a.frac[p++] : 0) + s_j * (take_b ? b.frac[q++] : 0)) / (s_i + s_j);
+    }
+    Compress(frac, phase, count, &frac_[i]);
+    mass_scale_[i] = s_i + s_j;
+    frac_dirty_[i] = true;
+    if(variable_smoothing_) {
+        Real h_i = smoothing_len_[i];
+        Real h_j = smoothing_len_[j];
+        smoothing_len_[i] = glm::min(std::sqrt(h_i * h_i + h_j * h_j), max_smoothing_len_);
+    }
+    calm_steps_[i] = glm::min(calm_steps_[i], calm_steps_[j]);
+}
+
+/**
+ * @brief calculate color of particles whose fractions changed
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::CalcCol() {
+    for(int i = 0; i < pos_.size(); i++) {
+        if(!frac_dirty_[i]) continue;
         col_[i] = glm::vec3(0.0f);
-        for(int k = 0; k < phase_.size(); k++)  {
-            col_[i] += frac_[i][k] * phase_[k].col;
+        for(int k = 0; k < frac_[i].count; k++)  {
+            col_[i] += float(frac_[i].frac[k]) * phase_[frac_[i].phase[k]].col;
         }
     }
 }
 
 /**
- * @brief calculate mixture values
+ * @brief calculate mixture values of particles whose fractions changed
  */
-void Simulater::CalcMixture() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::CalcMixture() {
     for(int i = 0; i < pos_.size(); i++) {
-        mass_[i] = 0.0f;
-        visc_[i] = 0.0f;
-        dens_[i] = 0.0f;
-        for(int k = 0; k < phase_.size(); k++)  {
-            mass_[i] += frac_[i][k] * phase_[k].mass;
-            visc_[i] += frac_[i][k] * phase_[k].visc;
-            dens_[i] += frac_[i][k] * phase_[k].dens;
+        if(!frac_dirty_[i]) continue;
+        mass_[i] = 0;
+        visc_[i] = 0;
+        dens_[i] = 0;
+        for(int k = 0; k < frac_[i].count; k++)  {
+            const Phase &phase = phase_[frac_[i].phase[k]];
+            mass_[i] += frac_[i].frac[k] * phase.mass;
+            visc_[i] += frac_[i].frac[k] * phase.visc;
+            dens_[i] += frac_[i].frac[k] * phase.dens;
+        }
+        mass_[i] *= mass_scale_[i];
+    }
+}
+
+/**
+ * @brief clear flags of changed fractions once both mixture and color have been recalculated
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::ClearDirtyFractions() {
+    std::fill(frac_dirty_.begin(), frac_dirty_.end(), false);
+}
+
+/**
+ * @brief keep the largest nonzero fractions that fit into a particle, renormalized when some are dropped
+ * @param[in] frac fractions
+ * @param[in] phase phases of fractions in ascending order, nullptr if frac is indexed by phase
+ * @param[in] count number of fractions
+ * @param[out] sparse nonzero fractions
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Compress(const Real *frac, const int *phase, int count, fraction *sparse) const {
+    // repeatedly pick largest fraction not picked yet, earlier one on ties
+    int picked[kMaxPhasesPerParticle];
+    int num_picked = 0;
+    int num_nonzero = 0;
+    for(int c = 0; c < count; c++) {
+        if(frac[c] > 0) num_nonzero++;
+    }
+    while(num_picked < glm::min(num_nonzero, kMaxPhasesPerParticle)) {
+        int best = -1;
+        for(int c = 0; c < count; c++) {
+            if(frac[c] <= 0 || std::find(picked, picked + num_picked, c) != picked + num_picked) continue;
+            if(best < 0 || frac[c] > frac[best]) best = c;
         }
+        picked[num_picked++] = best;
+    }
+    std::sort(picked, picked + num_picked);
+
+    Real sum = 0;
+    for(int k = 0; k < num_picked; k++) {
+        sparse->phase[k] = phase ? phase[picked[k]] : picked[k];
+        sparse->frac[k] = frac[picked[k]];
+        sum += sparse->frac[k];
+    }
+    sparse->count = num_picked;
+    if(num_picked < num_nonzero) {
+        for(int k = 0; k < num_picked; k++) sparse->frac[k] /= sum;
     }
 }
 
+/**
+ * @brief calculate largest difference of fractions over phases of two particles
+ * @param[in] a fractions of a particle
+ * @param[in] b fractions of another particle
+ * @return largest absolute difference
+ */
+template<typename Real, typename Accum>
+Real Simulater<Real, Accum>::CalcFractionJump(const fraction &a, const fraction &b) const {
+    Real jump = 0;
+    for(int p = 0, q = 0; p < a.count || q < b.count;) {
+        if(q == b.count || (p < a.count && a.phase[p] < b.phase[q])) {
+            jump = glm::max(jump, std::abs(a.frac[p++]));
+        } else if(p == a.count || b.phase[q] < a.phase[p]) {
+            jump = glm::max(jump, std::abs(b.frac[q++]));
+        } else {
+            jump = glm::max(jump, std::abs(a.frac[p++] - b.frac[q++]));
+        }
+    }
+    return jump;
+}
+
 /**
  * @brief calculate interpolated density
  */
-void Simulater::CalcInterpDens() {
-    std::vector<float> tmp(pos_.size(), 0.0f);
-    for(int i = 0; i < pos_.size(); i++) {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::CalcInterpDens() {
+    int nb = num_particles_[kBoundary];
+    Accum *tmp = arena_.Allocate<Accum>(pos_.size(), 0);
+    for(int i = 0; i < nb; i++) {
+        tmp[i] = boundary_dens_[i];
+    }
+    // scatter to boundary particles in order of id so that sums do not depend on indices
+    int *order = arena_.Allocate<int>(pos_.size() - nb);
+    std::iota(order, order + pos_.size() - nb, nb);
+    if(deterministic_ && nb > 0) {
+        std::sort(order, order + pos_.size() - nb, [&](int a, int b) { return id_[a] < id_[b]; });
+    }
+    for(int k = 0; k < pos_.size() - nb; k++) {
+        int i = order[k];
         for(int j: neighbor_[i]) {
-            glm::vec2 r_ij = pos_[i] - pos_[j];
-            float r = glm::length(r_ij);
-            tmp[i] += mass_[j] * kernel_(r, effective_rad_);
+            real2 r_ij = MinimumImage(pos_[i] - pos_[j], periodic_, period_);
+            Real r = glm::length(r_ij);
+            Real w = kernel_(r, (smoothing_len_[i] + smoothing_len_[j]) / 2);
+            tmp[i] += mass_[j] * w;
+            // boundary particles only receive contributions from moving ones
+            if(j < nb) tmp[j] += mass_[i] * w;
+        }
+    }
+    // terms of all wall surfaces near particle, kept for forces and viscosity
+    if(boundary_model_ == kBoundaryWall) {
+        wall_dist_.resize(pos_.size());
+        wall_grad_.resize(pos_.size());
+        wall_lap_.resize(pos_.size());
+        for(int i = nb; i < pos_.size(); i++) {
+            Real dens;
+            wall_dist_[i] = wall_->Sum(pos_[i], smoothing_len_[i], &dens, &wall_grad_[i], &wall_lap_[i]);
+            tmp[i] += dens;
         }
     }
     for(int i = 0; i < pos_.size(); i++) {
@@ -252,70 +1252,496 @@ void Simulater::CalcInterpDens() {
 /**
  * @brief calculate acceleration
  */
-void Simulater::CalcAcc() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::CalcAcc() {
+    // predictor-corrector moves ghosts like their owners, so they need forces at predicted state as well
+    bool ghosts = integrator_ == kIntegratorPredictorCorrector;
     for(int i = 0; i < pos_.size(); i++) {
-        if(attr_[i] == kBoundary) continue;
+        if(attr_[i] == kBoundary || (attr_[i] == kGhost && !ghosts) || IsAsleep(i)) continue;
 
-        acc_[i] = glm::vec2(0.0f);
+        accum2 acc = accum2(0);
 
         for(int j: neighbor_[i]) {
             if(j == i) continue;
-            glm::vec2 r_ij = pos_[i] - pos_[j];
-            float r = glm::length(r_ij);
-            acc_[i] += -kGravityAcceleration / dens_[i] * mass_[j] * gkernel_(r_ij, r, effective_rad_);
+            real2 r_ij = MinimumImage(pos_[i] - pos_[j], periodic_, period_);
+            Real r = glm::length(r_ij);
+            acc += accum2(-kGravityAcceleration / dens_[i] * mass_[j] * gkernel_(r_ij, r, (smoothing_len_[i] + smoothing_len_[j]) / 2));
         }
-        for(int j: neighbor_[i]) {
-            glm::vec2 r_ij = pos_[i] - pos_[j];
-            float r = glm::length(r_ij);
-            acc_[i] += visc_[i] / interp_dens_[i] * mass_[j] * (vel_[j] - vel_[i]) / interp_dens_[j] * lkernel_(r, effective_rad_);
+        if(!implicit_viscosity_) {
+            for(int j: neighbor_[i]) {
+                real2 r_ij = MinimumImage(pos_[i] - pos_[j], periodic_, period_);
+                Real r = glm::length(r_ij);
+                acc += accum2(visc_[i] / interp_dens_[i] * mass_[j] * (vel_[j] - vel_[i]) / interp_dens_[j] * lkernel_(r, (smoothing_len_[i] + smoothing_len_[j]) / 2));
+            }
         }
 
-        float d = 0.01f;
-        glm::vec2 dx = glm::vec2(d, 0.0f);
-        glm::vec2 dz = glm::vec2(0.0f, d);
-        acc_[i][0] += -kGravityAcceleration * (terrain_->GetHeight(pos_[i]+dx) - terrain_->GetHeight(pos_[i]-dx)) / (2*d);
-        acc_[i][1] += -kGravityAcceleration * (terrain_->GetHeight(pos_[i]+dz) - terrain_->GetHeight(pos_[i]-dz)) / (2*d);
+        // wall at rest, contributions of boundary layers precomputed by distance and summed over surfaces
+        if(boundary_model_ == kBoundaryWall && wall_dist_[i] < smoothing_len_[i]) {
+            acc += accum2(-kGravityAcceleration / dens_[i] * wall_grad_[i]);
+            if(!implicit_viscosity_) acc += accum2(-visc_[i] / interp_dens_[i] * wall_lap_[i] * vel_[i]);
+        }
+
+        Real d = 0.01;
+        real2 dx = real2(d, 0);
+        real2 dz = real2(0, d);
+        acc_[i] = real2(acc);
+        acc_[i][0] += -kGravityAcceleration * (terrain_->GetHeight(glm::vec2(pos_[i]+dx)) - terrain_->GetHeight(glm::vec2(pos_[i]-dx))) / (2*d);
+        acc_[i][1] += -kGravityAcceleration * (terrain_->GetHeight(glm::vec2(pos_[i]+dz)) - terrain_->GetHeight(glm::vec2(pos_[i]-dz))) / (2*d);
     }
 }
 
 /**
  * @brief calculate height
  */
-void Simulater::CalcHeight() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::CalcHeight() {
     for(int i = 0; i < pos_.size(); i++) {
-        if(attr_[i] == kBoundary) continue;
-        height_[i] = interp_dens_[i] / dens_[i] + terrain_->GetHeight(pos_[i]);
+        if(attr_[i] != kFluid) continue;
+        height_[i] = interp_dens_[i] / dens_[i] + terrain_->GetHeight(glm::vec2(pos_[i]));
     }
 }
 
 /**
- * @brief integrate
+ * @brief first half of split integrators, kick velocity half step and drift positions whole step
  */
-void Simulater::Integrate() {
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Drift() {
     for(int i = 0; i < pos_.size(); i++) {
-        if(attr_[i] == kBoundary) continue;
+        if(attr_[i] != kFluid || IsAsleep(i)) continue;
+        vel_[i] += dt_ / 2 * acc_[i];
+        LimitVelocity(i);
+        pos_[i] += dt_ * vel_[i];
+        Collide(i);
+    }
+}
 
-        vel_[i] += dt_ * acc_[i];
+/**
+ * @brief keep half step velocities for closing kick, once particles of this step are final
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::PredictVelocity() {
+    vel_start_.assign(vel_.begin(), vel_.end());
 
-        float v_max = sqrtf(kGravityAcceleration * interp_dens_[i] / dens_[i]);
-        float v_len = glm::length(vel_[i]);
-        if(v_len > v_max) vel_[i] *= v_max / v_len;
+    // modified velocity Verlet evaluates viscosity with velocity predicted past half step, ghosts as their owners do
+    if(integrator_ != kIntegratorVerlet) return;
+    for(int i = 0; i < pos_.size(); i++) {
+        if(attr_[i] == kBoundary || IsAsleep(i)) continue;
+        vel_[i] += (verlet_lambda_ - Real(0.5)) * dt_ * acc_[i];
+    }
+}
 
-        pos_[i] += dt_ * vel_[i];
+/**
+ * @brief integrate
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Integrate() {
+    switch(integrator_) {
+        case kIntegratorEuler:
+            // semi-implicit Euler
+            for(int i = 0; i < pos_.size(); i++) {
+                if(attr_[i] != kFluid || IsAsleep(i)) continue;
+                vel_[i] += dt_ * acc_[i];
+                if(UpdateActivity(i)) continue;
+                LimitVelocity(i);
+                pos_[i] += dt_ * vel_[i];
+                Collide(i);
+            }
+            break;
 
+        case kIntegratorLeapfrog:
+        case kIntegratorVerlet:
+            // closing half kick with forces at drifted positions
+            for(int i = 0; i < pos_.size(); i++) {
+                if(attr_[i] != kFluid || IsAsleep(i)) continue;
+                vel_[i] = vel_start_[i] + dt_ / 2 * acc_[i];
+                if(UpdateActivity(i)) continue;
+                LimitVelocity(i);
+            }
+            break;
+
+        case kIntegratorPredictorCorrector: {
+            // predictor, semi-implicit Euler step, ghosts follow their owners
+            int n = pos_.size();
+            pos_start_.resize(n);
+            vel_start_.resize(n);
+            acc_start_.resize(n);
+            for(int i = 0; i < n; i++) {
+                pos_start_[i] = pos_[i];
+                vel_start_[i] = vel_[i];
+                acc_start_[i] = acc_[i];
+                if(attr_[i] == kBoundary || IsAsleep(i)) continue;
+                vel_[i] += dt_ * acc_[i];
+                LimitVelocity(i);
+                pos_[i] += dt_ * vel_[i];
+                Collide(i);
+            }
+
+            // forces at predicted state, neighbor lists of start of step are reused
+            CalcInterpDens();
+            CalcAcc();
+
+            // corrector, trapezoidal rule
+            for(int i = 0; i < n; i++) {
+                if(attr_[i] == kBoundary || IsAsleep(i)) continue;
+                vel_[i] = vel_start_[i] + dt_ / 2 * (acc_start_[i] + acc_[i]);
+                if(UpdateActivity(i)) {
+                    pos_[i] = pos_start_[i];
+                    continue;
+                }
+                LimitVelocity(i);
+                pos_[i] = pos_start_[i] + dt_ / 2 * (vel_start_[i] + vel_[i]);
+                Collide(i);
+            }
+
+            // depths at corrected positions, for heights of this step
+            CalcInterpDens();
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief count calm steps of particle and stop it once asleep
+ * @param[in] i particle index
+ * @return asleep or not
+ */
+template<typename Real, typename Accum>
+bool Simulater<Real, Accum>::UpdateActivity(int i) {
+    // fall asleep after staying calm for a while
+    if(glm::length(vel_[i]) < sleep_vel_ && glm::length(acc_[i]) < sleep_acc_) {
+        calm_steps_[i]++;
+    } else {
+        calm_steps_[i] = 0;
+    }
+    if(!IsAsleep(i)) return false;
+    vel_[i] = real2(0);
+    return true;
+}
+
+/**
+ * @brief limit velocity of particle to wave speed of its water column
+ * @param[in] i particle index
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::LimitVelocity(int i) {
+    Real v_max = std::sqrt(kGravityAcceleration * interp_dens_[i] / dens_[i]);
+    Real v_len = glm::length(vel_[i]);
+    if(v_len > v_max) vel_[i] *= v_max / v_len;
+}
+
+/**
+ * @brief keep particle inside domain
+ * @param[in] i particle index
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Collide(int i) {
+    for(int a = 0; a < 2; a++) {
+        if(periodic_[a]) pos_[i][a] -= period_[a] * std::floor((pos_[i][a] - min_coord_[a]) / period_[a]);
+    }
+    if(boundary_model_ == kBoundaryParticle) {
         pos_[i] = glm::clamp(pos_[i], min_coord_, max_coord_);
+        return;
+    }
+
+    // push back onto wall surface and drop velocity into wall
+    Real d = wall_->Distance(pos_[i]);
+    if(d < 0) {
+        real2 n = wall_->Normal(pos_[i]);
+        pos_[i] -= d * n;
+        Real vn = glm::dot(vel_[i], n);
+        if(vn < 0) vel_[i] -= vn * n;
     }
 }
 
+/**
+ * @brief diffuse velocities implicitly by preconditioned conjugate gradient over neighbor graph
+ * @details solves m_i v_i + dt sum_j k_ij (v_i - v_j) + dt m_i w_i v_i = m_i v*_i for awake fluid particles,
+ *          k_ij = m_i m_j mu_ij lap_ij / (rho_i rho_j) with mean viscosity mu_ij of pair is symmetric,
+ *          so the system is positive definite, other particles enter with fixed velocities
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SolveViscosity() {
+    int n = pos_.size();
+    int num_threads = glm::clamp(n / 2048, 1, max_threads_);
+    ThreadPool *pool = GetPool();
+    auto parallel = [&](const auto &fn) {
+        pool->Run(num_threads, [&](int k) { fn(k, n * k / num_threads, n * (k+1) / num_threads); });
+    };
+    auto sum = [&](const glm::dvec2 *partial) {
+        glm::dvec2 total = glm::dvec2(0.0);
+        for(int k = 0; k < num_threads; k++) total += partial[k];
+        return total;
+    };
+
+    // coefficients are cached along neighbor lists, which are the sparsity of the matrix
+    bool *unknown = arena_.Allocate<bool>(n);
+    int *offset = arena_.Allocate<int>(n + 1);
+    offset[0] = 0;
+    for(int i = 0; i < n; i++) {
+        unknown[i] = attr_[i] == kFluid && !IsAsleep(i);
+        offset[i+1] = offset[i] + (unknown[i] ? neighbor_[i].size() : 0);
+    }
+    Real *coef = arena_.Allocate<Real>(offset[n]);
+    Accum *diag = arena_.Allocate<Accum>(n);
+    accum2 *x = arena_.Allocate<accum2>(n);
+    accum2 *r = arena_.Allocate<accum2>(n);
+    accum2 *z = arena_.Allocate<accum2>(n);
+    accum2 *p = arena_.Allocate<accum2>(n);
+    accum2 *ap = arena_.Allocate<accum2>(n);
+    glm::dvec2 *partial = arena_.Allocate<glm::dvec2>(num_threads, glm::dvec2(0.0));
+    glm::dvec2 *partial_rr = arena_.Allocate<glm::dvec2>(num_threads, glm::dvec2(0.0));
+
+    // start from current velocities, residual is dt m_i times explicit viscous acceleration
+    parallel([&](int k, int begin, int end) {
+        glm::dvec2 rz = glm::dvec2(0.0);
+        glm::dvec2 bb = glm::dvec2(0.0);
+        for(int i = begin; i < end; i++) {
+            x[i] = accum2(vel_[i]);
+            r[i] = z[i] = p[i] = accum2(0);
+            if(!unknown[i]) continue;
+
+            // wall at rest only adds to diagonal
+            Accum wall = 0;
+            if(boundary_model_ == kBoundaryWall && wall_dist_[i] < smoothing_len_[i]) {
+                wall = dt_ * mass_[i] * glm::max(visc_[i] / interp_dens_[i] * wall_lap_[i], Real(0));
+            }
+            Accum d = mass_[i] + wall;
+            accum2 force = accum2(0);
+            int e = offset[i];
+            for(int j: neighbor_[i]) {
+                Real c = 0;
+                if(j != i) {
+                    Real dist = glm::length(MinimumImage(pos_[i] - pos_[j], periodic_, period_));
+                    Real mu = (visc_[i] + visc_[j]) / 2;
+                    c = dt_ * mass_[i] * mass_[j] * mu * lkernel_(dist, (smoothing_len_[i] + smoothing_len_[j]) / 2) / (interp_dens_[i] * interp_dens_[j]);
+                }
+                coef[e++] = c;
+                d += c;
+                force += accum2(c * (vel_[j] - vel_[i]));
+            }
+            diag[i] = d;
+            r[i] = force - wall * accum2(vel_[i]);
+            z[i] = r[i] / d;
+            p[i] = z[i];
+            rz += glm::dvec2(r[i] * z[i]);
+            accum2 b = Accum(mass_[i]) * accum2(vel_[i]);
+            bb += glm::dvec2(b * b);
+        }
+        partial[k] = rz;
+        partial_rr[k] = bb;
+    });
+    glm::dvec2 rz = sum(partial);
+    glm::dvec2 tol2 = double(viscosity_tol_ * viscosity_tol_) * sum(partial_rr);
+
+    // components are independent systems sharing the matrix
+    viscosity_iterations_ = 0;
+    while(viscosity_iterations_ < max_viscosity_iterations_) {
+        parallel([&](int k, int begin, int end) {
+            glm::dvec2 pap = glm::dvec2(0.0);
+            for(int i = begin; i < end; i++) {
+                if(!unknown[i]) continue;
+                accum2 q = diag[i] * p[i];
+                int e = offset[i];
+                for(int j: neighbor_[i]) {
+                    if(unknown[j]) q -= Accum(coef[e]) * p[j];
+                    e++;
+                }
+                ap[i] = q;
+                pap += glm::dvec2(p[i] * q);
+            }
+            partial[k] = pap;
+        });
+        glm::dvec2 pap = sum(partial);
+        accum2 alpha = accum2(glm::dvec2(pap[0] > 0.0 ? rz[0] / pap[0] : 0.0, pap[1] > 0.0 ? rz[1] / pap[1] : 0.0));
+
+        parallel([&](int k, int begin, int end) {
+            glm::dvec2 rz_new = glm::dvec2(0.0);
+            glm::dvec2 rr = glm::dvec2(0.0);
+            for(int i = begin; i < end; i++) {
+                if(!unknown[i]) continue;
+                x[i] += alpha * p[i];
+                r[i] -= alpha * ap[i];
+                z[i] = r[i] / diag[i];
+                rz_new += glm::dvec2(r[i] * z[i]);
+                rr += glm::dvec2(r[i] * r[i]);
+            }
+            partial[k] = rz_new;
+            partial_rr[k] = rr;
+        });
+        viscosity_iterations_++;
+        glm::dvec2 rz_new = sum(partial);
+        glm::dvec2 rr = sum(partial_rr);
+        if(rr[0] <= tol2[0] && rr[1] <= tol2[1]) break;
+
+        accum2 beta = accum2(glm::dvec2(rz[0] > 0.0 ? rz_new[0] / rz[0] : 0.0, rz[1] > 0.0 ? rz_new[1] / rz[1] : 0.0));
+        rz = rz_new;
+        parallel([&](int, int begin, int end) {
+            for(int i = begin; i < end; i++) {
+                if(unknown[i]) p[i] = z[i] + beta * p[i];
+            }
+        });
+    }
+
+    for(int i = 0; i < n; i++) {
+        if(unknown[i]) vel_[i] = real2(x[i]);
+    }
+}
+
+/**
+ * @brief scale smoothing lengths toward target number of neighbors for next step
+ * @param[out] smoothing_len smoothing lengths of next step
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::UpdateSmoothingLength(Real *smoothing_len) {
+    for(int i = 0; i < pos_.size(); i++) {
+        smoothing_len[i] = smoothing_len_[i];
+        if(attr_[i] != kFluid) continue;
+
+        // number of neighbors grows with area, counted within h itself rather than the pair radii of the neighbor lists
+        // change is limited to [0.8, 1.25] per step for stability, so a particle far from its target takes several steps
+        Real h_start = smoothing_len_[i];
+        Real lower = glm::max(h_start * Real(0.8), min_smoothing_len_);
+        Real upper = glm::min(h_start * Real(1.25), max_smoothing_len_);
+        Real h = h_start;
+        for(int k = 0; k < kSmoothingIterations; k++) {
+            int count = mnn_->Count(pos_[i], h, pos_) + boundary_nn_->Count(pos_[i], pos_, h);
+            Real next = glm::clamp(h * std::sqrt(Real(target_neighbors_) / glm::max(count, 1)), lower, upper);
+            if(next == h) break;
+            h = next;
+        }
+        smoothing_len[i] = h;
+    }
+}
+
+/**
+ * @brief replace gauges, sorted by cell for locality
+ * @param[in] points gauge positions
+ * @param[in] path log file
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SetGauges(const std::vector<glm::vec2> &points, const std::string &path) {
+    gauges_ = std::make_unique<Gauges>(points, path);
+    gauge_order_.resize(points.size());
+    std::iota(gauge_order_.begin(), gauge_order_.end(), 0);
+    std::sort(gauge_order_.begin(), gauge_order_.end(), [&](int a, int b) {
+        return nn_->GetCellHash(real2(points[a])) < nn_->GetCellHash(real2(points[b]));
+    });
+}
+
+/**
+ * @brief sample depth, height and velocity at gauges in parallel and log them
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::SampleGauges() {
+    // contiguous runs of sorted gauges per worker, so a worker walks nearby cells
+    const std::vector<glm::vec2> &points = gauges_->GetPoints();
+    int n = gauge_order_.size();
+    int num_threads = glm::clamp(n / 64, 1, max_threads_);
+    if(gauge_neighbors_.size() < num_threads) gauge_neighbors_.resize(num_threads);
+
+    GetPool()->Run(num_threads, [&](int k) {
+        std::vector<int> &neighbors = gauge_neighbors_[k];
+        for(int m = n * k / num_threads; m < n * (k+1) / num_threads; m++) {
+            int g = gauge_order_[m];
+            real2 r = real2(points[g]);
+            neighbors.clear();
+            if(variable_smoothing_) {
+                mnn_->Search(r, effective_rad_, pos_, &neighbors);
+            } else {
+                nn_->Search(r, pos_, &neighbors, effective_rad_);
+            }
+
+            // Shepard interpolation, weight sum is depth at gauge
+            Accum depth = 0;
+            Accum height = 0;
+            accum2 vel = accum2(0);
+            for(int j: neighbors) {
+                if(attr_[j] == kBoundary) continue;
+                Real w = mass_[j] / dens_[j] * kernel_(glm::length(MinimumImage(r - pos_[j], periodic_, period_)), (effective_rad_ + smoothing_len_[j]) / 2);
+                depth += w;
+                height += w * height_[j];
+                vel += accum2(w * vel_[j]);
+            }
+            GaugeSample sample;
+            sample.depth = float(depth);
+            sample.height = depth > 0 ? float(height / depth) : terrain_->GetHeight(points[g]);
+            sample.vel = depth > 0 ? glm::vec2(vel / depth) : glm::vec2(0.0f);
+            gauges_->SetSample(g, sample);
+        }
+    });
+
+    gauges_->Write(num_steps_ * double(dt_));
+}
+
+/**
+ * @brief record time since last lap as stage time
+ * @param[in] stage stage
+ * @param[in,out] tic start of stage, reset to now
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::Lap(Stage stage, std::chrono::steady_clock::time_point *tic) {
+    auto toc = std::chrono::steady_clock::now();
+    stage_time_[stage] += std::chrono::duration<double>(toc - *tic).count();
+    *tic = toc;
+}
+
+/**
+ * @brief get pool of parallel stages, started with max_threads_ threads on first use
+ * @return pool
+ */
+template<typename Real, typename Accum>
+ThreadPool *Simulater<Real, Accum>::GetPool() {
+    if(!pool_) pool_ = std::make_unique<ThreadPool>(max_threads_);
+    return pool_.get();
+}
+
 /**
  * @brief update buffers
  */
-void Simulater::UpdateBuffer() {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    // pos
-    glBufferSubData(GL_ARRAY_BUFFER, 0, pos_.size() * sizeof(glm::vec2), pos_.data());
-    // height
-    glBufferSubData(GL_ARRAY_BUFFER, pos_.size() * sizeof(glm::vec2), pos_.size() * sizeof(float), height_.data());
-    // col
-    glBufferSubData(GL_ARRAY_BUFFER, pos_.size() * (sizeof(glm::vec2) + sizeof(float)), pos_.size() * sizeof(glm::vec3), col_.data());
-}
\ No newline at end of file
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::UpdateBuffer() {
+    if(buffer_updated_) return;
+    // vertex attributes are always single precision
+    int n = pos_.size();
+    buffer_pos_.resize(n);
+    buffer_height_.resize(n);
+    for(int i = 0; i < n; i++) {
+        buffer_pos_[i] = glm::vec2(pos_[i]);
+        buffer_height_[i] = float(height_[i]);
+    }
+    renderer_->Update(buffer_pos_, buffer_height_, col_);
+    buffer_updated_ = true;
+}
+
+/**
+ * @brief resample water surface from fluid particles
+ */
+template<typename Real, typename Accum>
+void Simulater<Real, Accum>::UpdateSurface() {
+    if(surface_updated_) return;
+    if(!surface_) {
+        surface_ = std::make_unique<Surface>(glm::vec2(min_coord_), glm::vec2(max_coord_), float(2*particle_rad_), float(effective_rad_), num_particles_[kFluid]);
+    }
+    int begin = num_particles_[kBoundary];
+    int end = begin + num_particles_[kFluid];
+    surface_pos_.resize(end - begin);
+    surface_ids_.assign(id_.begin() + begin, id_.begin() + end);
+    surface_vol_.resize(end - begin);
+    surface_height_.resize(end - begin);
+    for(int i = begin; i < end; i++) {
+        surface_pos_[i-begin] = glm::vec2(pos_[i]);
+        surface_vol_[i-begin] = float(mass_[i] / dens_[i]);
+        surface_height_[i-begin] = float(height_[i]);
+    }
+    surface_->Update(surface_pos_, surface_ids_, surface_vol_, surface_height_, terrain_.get(), GetPool());
+    surface_updated_ = true;
+}
+
+// explicit instantiation
+
+template class Simulater<float>;
+template class Simulater<double>;
+template class Simulater<float, double>;
\ No newline at end of file
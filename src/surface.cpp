@@ -0,0 +1,271 @@
+/**
+ * @file surface.cpp
+ * @brief Implementation of water surface reconstruction
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "surface.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] min_coord minimum coordinate
+ * @param[in] max_coord maximum coordinate
+ * @param[in] spacing spacing of grid vertices
+ * @param[in] effective_radius effective radius of interpolation
+ * @param[in] num_particles number of particles
+ */
+Surface::Surface(const glm::vec2 &min_coord, const glm::vec2 &max_coord, float spacing, float effective_radius, int num_particles)
+: min_coord_(min_coord), spacing_(spacing), effective_rad_(effective_radius), tile_size_(16), num_dirty_(0), dry_depth_(0.01f) {
+    // round grid up to whole tiles
+    glm::ivec2 num_cells = glm::ivec2(glm::ceil((max_coord - min_coord) / spacing_));
+    num_tiles_ = (num_cells + tile_size_ - 1) / tile_size_;
+    num_vertices_ = num_tiles_ * tile_size_ + 1;
+    grid_height_.resize(num_vertices_[0] * num_vertices_[1]);
+
+    int num_tiles = GetNumTiles();
+    dirty_.resize(num_tiles, false);
+    stale_.resize(num_tiles, false);
+    vertices_.resize(num_tiles * (tile_size_+1) * (tile_size_+1));
+    normals_.resize(vertices_.size());
+
+    nn_ = std::make_unique<NearestNeighbor<float>>(min_coord, max_coord, effective_rad_, num_particles);
+}
+
+/**
+ * @brief destructor
+ */
+Surface::~Surface() {
+
+}
+
+/**
+ * @brief resample heights and rebuild mesh in tiles touched by moving, added or removed particles
+ * @param[in] pos positions of fluid particles
+ * @param[in] ids ids of fluid particles
+ * @param[in] vol volumes of fluid particles, mass over density
+ * @param[in] height heights of fluid particles
+ * @param[in] terrain terrain
+ * @param[in] pool pool tiles are splatted on
+ */
+void Surface::Update(const std::vector<glm::vec2> &pos, const std::vector<int> &ids, const std::vector<float> &vol, const std::vector<float> &height, const Terrain *terrain, ThreadPool *pool) {
+    // tiles covered by kernel of particles before and after moving, walking both lists in order of survivors
+    std::fill(dirty_.begin(), dirty_.end(), false);
+    int n = pos.size();
+    int a = 0;
+    int b = 0;
+    while(a < prev_ids_.size() && b < n) {
+        if(prev_ids_[a] == ids[b]) {
+            if(pos[b] != prev_pos_[a]) {
+                MarkTiles(prev_pos_[a], &dirty_);
+                MarkTiles(pos[b], &dirty_);
+            }
+            a++;
+            b++;
+        } else {
+            MarkTiles(prev_pos_[a++], &dirty_);
+        }
+    }
+    for(; a < prev_ids_.size(); a++) MarkTiles(prev_pos_[a], &dirty_);
+    for(; b < n; b++) MarkTiles(pos[b], &dirty_);
+    prev_pos_ = pos;
+    prev_ids_ = ids;
+
+    tiles_.clear();
+    for(int t = 0; t < dirty_.size(); t++) {
+        if(dirty_[t]) tiles_.push_back(t);
+    }
+    num_dirty_ = tiles_.size();
+    if(tiles_.empty()) return;
+
+    // each tile writes only vertices it owns, so tiles are splatted in parallel
+    nn_->Register(pos);
+    int num_tasks = glm::min(pool->GetNumThreads(), num_dirty_);
+    if(neighbors_.size() < num_tasks) neighbors_.resize(num_tasks);
+    pool->Run(num_tasks, [&](int k) {
+        for(int m = k; m < tiles_.size(); m += num_tasks) Splat(tiles_[m], pos, vol, height, terrain, &neighbors_[k]);
+    });
+
+    // border vertices and normals depend on neighbor tiles
+    for(int tz = 0; tz < num_tiles_[1]; tz++) {
+        for(int tx = 0; tx < num_tiles_[0]; tx++) {
+            bool touched = false;
+            for(int dz = -1; dz <= 1; dz++) {
+                for(int dx = -1; dx <= 1; dx++) {
+                    int x = tx + dx;
+                    int z = tz + dz;
+                    if(x < 0 || z < 0 || x >= num_tiles_[0] || z >= num_tiles_[1]) continue;
+                    touched = touched || dirty_[z*num_tiles_[0] + x];
+                }
+            }
+            if(!touched) continue;
+            int t = tz*num_tiles_[0] + tx;
+            BuildTile(t);
+            stale_[t] = true;
+        }
+    }
+}
+
+/**
+ * @brief draw surface
+ */
+void Surface::Draw() {
+    int block = (tile_size_+1) * (tile_size_+1);
+
+    // lazily built, as terrain
+    if(!mesh_) {
+        mesh_ = std::make_unique<Mesh>(vertices_.size());
+        mesh_->vertices_ = vertices_;
+        mesh_->normals_ = normals_;
+        BuildIndices();
+        mesh_->SendDataToBuffer();
+        std::fill(stale_.begin(), stale_.end(), false);
+    }
+    for(int t = 0; t < stale_.size(); t++) {
+        if(!stale_[t]) continue;
+        std::copy(vertices_.begin() + t*block, vertices_.begin() + (t+1)*block, mesh_->vertices_.begin() + t*block);
+        std::copy(normals_.begin() + t*block, normals_.begin() + (t+1)*block, mesh_->normals_.begin() + t*block);
+        mesh_->SendDataToBuffer(t*block, block);
+        stale_[t] = false;
+    }
+    mesh_->Draw();
+}
+
+/**
+ * @brief get number of tiles
+ * @return number of tiles
+ */
+int Surface::GetNumTiles() const {
+    return num_tiles_[0] * num_tiles_[1];
+}
+
+/**
+ * @brief get number of tiles resampled at last update
+ * @return number of tiles
+ */
+int Surface::GetNumDirtyTiles() const {
+    return num_dirty_;
+}
+
+/**
+ * @brief get memory held by surface on host
+ * @return bytes
+ */
+size_t Surface::GetMemoryUsage() const {
+    size_t bytes = grid_height_.capacity() * sizeof(float) + prev_pos_.capacity() * sizeof(glm::vec2) + prev_ids_.capacity() * sizeof(int);
+    bytes += (vertices_.capacity() + normals_.capacity()) * sizeof(glm::vec3);
+    bytes += nn_->GetMemoryUsage();
+    return bytes;
+}
+
+/**
+ * @brief mark tiles overlapping kernel support of particle
+ * @param[in] pos position of particle
+ * @param[in,out] marked flags of tiles
+ */
+void Surface::MarkTiles(const glm::vec2 &pos, std::vector<bool> *marked) const {
+    float tile_width = tile_size_ * spacing_;
+    glm::ivec2 lo = glm::ivec2(glm::floor((pos - effective_rad_ - min_coord_) / tile_width));
+    glm::ivec2 hi = glm::ivec2(glm::floor((pos + effective_rad_ - min_coord_) / tile_width));
+    lo = glm::clamp(lo, glm::ivec2(0), num_tiles_ - 1);
+    hi = glm::clamp(hi, glm::ivec2(0), num_tiles_ - 1);
+    for(int z = lo[1]; z <= hi[1]; z++) {
+        for(int x = lo[0]; x <= hi[0]; x++) {
+            marked->at(z*num_tiles_[0] + x) = true;
+        }
+    }
+}
+
+/**
+ * @brief interpolate heights at grid vertices owned by tile
+ * @param[in] tile tile
+ * @param[in] pos positions of fluid particles
+ * @param[in] vol volumes of fluid particles
+ * @param[in] height heights of fluid particles
+ * @param[in] terrain terrain
+ * @param[in,out] neighbors neighbor list of worker, reused over vertices
+ */
+void Surface::Splat(int tile, const std::vector<glm::vec2> &pos, const std::vector<float> &vol, const std::vector<float> &height, const Terrain *terrain, std::vector<int> *neighbors) {
+    // tile owns its far border only at the end of grid
+    int tx = tile % num_tiles_[0];
+    int tz = tile / num_tiles_[0];
+    int x_end = (tx+1)*tile_size_ + (tx == num_tiles_[0]-1 ? 1 : 0);
+    int z_end = (tz+1)*tile_size_ + (tz == num_tiles_[1]-1 ? 1 : 0);
+
+    for(int z = tz*tile_size_; z < z_end; z++) {
+        for(int x = tx*tile_size_; x < x_end; x++) {
+            glm::vec2 r = min_coord_ + glm::vec2(x, z) * spacing_;
+            neighbors->clear();
+            nn_->Search(r, pos, neighbors, effective_rad_);
+
+            // Shepard interpolation, weight sum is depth at vertex
+            float depth = 0.0f;
+            float sum = 0.0f;
+            for(int j: *neighbors) {
+                float w = vol[j] * Poly6(glm::length(r - pos[j]), effective_rad_);
+                depth += w;
+                sum += w * height[j];
+            }
+            float ground = terrain->GetHeight(r);
+            grid_height_[GetVertex(x, z)] = depth > dry_depth_ ? sum / depth : ground - dry_depth_;
+        }
+    }
+}
+
+/**
+ * @brief build vertices and normals of tile from grid heights
+ * @param[in] tile tile
+ */
+void Surface::BuildTile(int tile) {
+    int tx = tile % num_tiles_[0];
+    int tz = tile / num_tiles_[0];
+    int v_idx = tile * (tile_size_+1) * (tile_size_+1);
+    for(int lz = 0; lz <= tile_size_; lz++) {
+        for(int lx = 0; lx <= tile_size_; lx++) {
+            int x = tx*tile_size_ + lx;
+            int z = tz*tile_size_ + lz;
+            glm::vec2 r = min_coord_ + glm::vec2(x, z) * spacing_;
+            vertices_[v_idx] = glm::vec3(r[0], grid_height_[GetVertex(x, z)], r[1]);
+
+            // central difference, one sided at border of grid
+            int x0 = glm::max(x-1, 0), x1 = glm::min(x+1, num_vertices_[0]-1);
+            int z0 = glm::max(z-1, 0), z1 = glm::min(z+1, num_vertices_[1]-1);
+            float dhdx = (grid_height_[GetVertex(x1, z)] - grid_height_[GetVertex(x0, z)]) / ((x1 - x0) * spacing_);
+            float dhdz = (grid_height_[GetVertex(x, z1)] - grid_height_[GetVertex(x, z0)]) / ((z1 - z0) * spacing_);
+            normals_[v_idx] = glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
+            v_idx++;
+        }
+    }
+}
+
+/**
+ * @brief build triangles of all tiles
+ */
+void Surface::BuildIndices() {
+    int row = tile_size_ + 1;
+    mesh_->indices_.resize(GetNumTiles() * tile_size_ * tile_size_ * 6);
+    int i_idx = 0;
+    for(int t = 0; t < GetNumTiles(); t++) {
+        for(int lz = 0; lz < tile_size_; lz++) {
+            for(int lx = 0; lx < tile_size_; lx++) {
+                unsigned int idx = t*row*row + lz*row + lx;
+                mesh_->indices_[i_idx++] = idx;
+                mesh_->indices_[i_idx++] = idx + row;
+                mesh_->indices_[i_idx++] = idx + 1;
+                mesh_->indices_[i_idx++] = idx + 1;
+                mesh_->indices_[i_idx++] = idx + row;
+                mesh_->indices_[i_idx++] = idx + row + 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief get index of grid vertex
+ * @param[in] x index along x
+ * @param[in] z index along z
+ * @return index
+ */
+int Surface::GetVertex(int x, int z) const {
+    return z*num_vertices_[0] + x;
+}
\ No newline at end of file
@@ -15,9 +15,8 @@
  * @param[in] max_coord maximum coordinate
  */
 Terrain::Terrain(const ground &fn, const glm::vec2 &min_coord, const glm::vec2 &max_coord) 
-:fn_(fn), mesh_(33*33) {
-    int div = 32;
-    ConstructMesh(div, min_coord, max_coord);
+:fn_(fn), min_coord_(min_coord), max_coord_(max_coord) {
+
 }
 
 /**
@@ -30,8 +29,14 @@ Terrain::~Terrain() {
 /**
  * @brief draw terrain
  */
-void Terrain::Draw() {
-    mesh_.Draw();
+void Terrain::Draw() const {
+    // mesh is built on first draw so that headless runs need no GL context
+    if(!mesh_) {
+        int div = 32;
+        mesh_ = std::make_unique<Mesh>(33*33);
+        ConstructMesh(div, min_coord_, max_coord_);
+    }
+    mesh_->Draw();
 }
 
 /**
@@ -39,7 +44,7 @@ void Terrain::Draw() {
  * @param[in] r position
  * @return height
  */
-float Terrain::GetHeight(const glm::vec2 &r) {
+float Terrain::GetHeight(const glm::vec2 &r) const {
     float height = fn_(r);
     return height;
 }
@@ -50,7 +55,7 @@ float Terrain::GetHeight(const glm::vec2 &r) {
  * @param[in] min_coord minimum coordinate
  * @param[in] max_corrd maximum coordinate
  */
-void Terrain::ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::vec2 &max_coord) {
+void Terrain::ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::vec2 &max_coord) const {
     glm::vec2 size = max_coord - min_coord;
     glm::ivec2 div(num_div);
     glm::vec2 d = size / glm::vec2(div);
@@ -61,7 +66,7 @@ void Terrain::ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::
         for(int x = 0; x < div[0]; x++) {
             glm::vec2 r = min_coord + glm::vec2(x, z) * d;
             glm::vec3 p(r[0], GetHeight(r), r[1]);
-            mesh_.vertices_[v_idx++] = p;
+            mesh_->vertices_[v_idx++] = p;
         }
     }
 
@@ -72,9 +77,9 @@ void Terrain::ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::
             unsigned int idx = z*div[0] + x;
             unsigned int idx_x = idx + 1;
             unsigned int idx_z = idx + div[0];
-            mesh_.indices_[i_idx] = idx;
-            mesh_.indices_[i_idx] = idx_z;
-            mesh_.indices_[i_idx] = idx_x;
+            mesh_->indices_[i_idx] = idx;
+            mesh_->indices_[i_idx] = idx_z;
+            mesh_->indices_[i_idx] = idx_x;
         }
     }
 
@@ -83,11 +88,11 @@ void Terrain::ConstructMesh(int num_div, const glm::vec2 &min_coord, const glm::
             unsigned int idx = z*div[0] + x;
             unsigned int idx_x = idx - 1;
             unsigned int idx_z = idx - div[0];
-            mesh_.indices_[i_idx] = idx;
-            mesh_.indices_[i_idx] = idx_z;
-            mesh_.indices_[i_idx] = idx_x;
+            mesh_->indices_[i_idx] = idx;
+            mesh_->indices_[i_idx] = idx_z;
+            mesh_->indices_[i_idx] = idx_x;
         }
     }
 
-    mesh_.SendDataToBuffer();
+    mesh_->SendDataToBuffer();
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of thread pool
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "thread_pool.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] num_threads number of threads including the calling one
+ */
+ThreadPool::ThreadPool(int num_threads)
+: stop_(false), generation_(0), invoke_(nullptr), fn_(nullptr), num_tasks_(0), next_task_(0), num_finished_(0) {
+    for(int k = 1; k < num_threads; k++) workers_.emplace_back(&ThreadPool::Work, this);
+}
+
+/**
+ * @brief destructor
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for(std::thread &worker: workers_) worker.join();
+}
+
+/**
+ * @brief get number of threads including the calling one
+ * @return number of threads
+ */
+int ThreadPool::GetNumThreads() const {
+    return workers_.size() + 1;
+}
+
+/**
+ * @brief hand tasks to workers, run them on calling thread as well and wait until all workers are done
+ * @param[in] num_tasks number of tasks
+ * @param[in] invoke calls fn with task number
+ * @param[in] fn task
+ */
+void ThreadPool::Dispatch(int num_tasks, void (*invoke)(const void*, int), const void *fn) {
+    if(workers_.empty() || num_tasks <= 1) {
+        for(int k = 0; k < num_tasks; k++) invoke(fn, k);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        invoke_ = invoke;
+        fn_ = fn;
+        num_tasks_ = num_tasks;
+        next_task_ = 0;
+        num_finished_ = 0;
+        generation_++;
+    }
+    start_.notify_all();
+    RunTasks();
+
+    // fn is gone after return, so wait for workers which found no task as well
+    std::unique_lock<std::mutex> lock(mutex_);
+    finish_.wait(lock, [&] { return num_finished_ == workers_.size(); });
+}
+
+/**
+ * @brief take tasks of current batch until none is left
+ */
+void ThreadPool::RunTasks() {
+    for(int k = next_task_++; k < num_tasks_; k = next_task_++) invoke_(fn_, k);
+}
+
+/**
+ * @brief loop of worker, runs tasks of each new generation
+ */
+void ThreadPool::Work() {
+    int generation = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&] { return stop_ || generation_ != generation; });
+            if(stop_) return;
+            generation = generation_;
+        }
+        RunTasks();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            num_finished_++;
+        }
+        finish_.notify_one();
+    }
+}
\ No newline at end of file
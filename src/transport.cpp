@@ -0,0 +1,126 @@
+/**
+ * @file transport.cpp
+ * @brief Implementation of transport between subdomains
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "transport.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] rank rank of this process
+ * @param[in] size number of processes
+ */
+LocalSocketTransport::LocalSocketTransport(int rank, int size)
+: rank_(rank), size_(size) {
+    fds_.resize(size, -1);
+}
+
+/**
+ * @brief destructor
+ */
+LocalSocketTransport::~LocalSocketTransport() {
+    for(int fd: fds_) {
+        if(fd >= 0) close(fd);
+    }
+}
+
+/**
+ * @brief create connected transports for all processes
+ * @param[in] size number of processes
+ * @return transports indexed by rank, empty on failure
+ */
+std::vector<std::unique_ptr<LocalSocketTransport>> LocalSocketTransport::CreateGroup(int size) {
+    std::vector<std::unique_ptr<LocalSocketTransport>> group;
+    for(int r = 0; r < size; r++) {
+        group.push_back(std::make_unique<LocalSocketTransport>(r, size));
+    }
+    for(int i = 0; i < size; i++) {
+        for(int j = i+1; j < size; j++) {
+            int sv[2];
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+                std::cerr << "Failed to create socket pair" << std::endl;
+                return {};
+            }
+            group[i]->fds_[j] = sv[0];
+            group[j]->fds_[i] = sv[1];
+        }
+    }
+    return group;
+}
+
+/**
+ * @brief get rank
+ * @return rank
+ */
+int LocalSocketTransport::GetRank() const {
+    return rank_;
+}
+
+/**
+ * @brief get number of processes
+ * @return number of processes
+ */
+int LocalSocketTransport::GetSize() const {
+    return size_;
+}
+
+/**
+ * @brief send message
+ * @param[in] dst destination rank
+ * @param[in] data message
+ */
+void LocalSocketTransport::Send(int dst, const std::vector<char> &data) {
+    uint64_t size = data.size();
+    WriteAll(fds_[dst], reinterpret_cast<const char*>(&size), sizeof(size));
+    WriteAll(fds_[dst], data.data(), data.size());
+}
+
+/**
+ * @brief receive message
+ * @param[in] src source rank
+ * @param[out] data message
+ */
+void LocalSocketTransport::Receive(int src, std::vector<char> *data) {
+    uint64_t size = 0;
+    ReadAll(fds_[src], reinterpret_cast<char*>(&size), sizeof(size));
+    data->resize(size);
+    ReadAll(fds_[src], data->data(), size);
+}
+
+/**
+ * @brief write whole buffer to socket
+ * @param[in] fd file descriptor
+ * @param[in] data buffer
+ * @param[in] size buffer size
+ */
+void LocalSocketTransport::WriteAll(int fd, const char *data, size_t size) {
+    while(size > 0) {
+        ssize_t n = write(fd, data, size);
+        if(n <= 0) {
+            std::cerr << "Failed to send message from rank " << rank_ << std::endl;
+            _exit(1);
+        }
+        data += n;
+        size -= n;
+    }
+}
+
+/**
+ * @brief read whole buffer from socket
+ * @param[in] fd file descriptor
+ * @param[out] data buffer
+ * @param[in] size buffer size
+ */
+void LocalSocketTransport::ReadAll(int fd, char *data, size_t size) {
+    while(size > 0) {
+        ssize_t n = read(fd, data, size);
+        if(n <= 0) {
+            std::cerr << "Failed to receive message on rank " << rank_ << std::endl;
+            _exit(1);
+        }
+        data += n;
+        size -= n;
+    }
+}
\ No newline at end of file
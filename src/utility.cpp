@@ -19,10 +19,11 @@
  * @param[in] h effective_radius
  * @return interpolated physical quantity
  */
-float Interpolate(const std::vector<float> &m, const std::vector<float> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const kernel &w, float h) {
-    float val = 0.0f;
+template<typename T>
+T Interpolate(const std::vector<T> &m, const std::vector<T> &phi, const std::vector<T> &rho, const std::vector<glm::vec<2, T>> &r, int i, const std::vector<int> &indices, const kernel<T> &w, T h) {
+    T val = 0;
     for(int j : indices) {
-        glm::vec2 r_ij = r[i] - r[j];
+        glm::vec<2, T> r_ij = r[i] - r[j];
         val += m[j] * phi[j] / rho[j] * w(glm::length(r_ij), h);
     }
     return val;
@@ -40,11 +41,12 @@ float Interpolate(const std::vector<float> &m, const std::vector<float> &phi, co
  * @param[in] h effective_radius
  * @return interpolated gradient of physical quantity
  */
-glm::vec2 InterpolateGradient(const std::vector<float> &m, const std::vector<float> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const gkernel &w, float h) {
-    glm::vec2 val = glm::vec2(0.0f, 0.0f);
+template<typename T>
+glm::vec<2, T> InterpolateGradient(const std::vector<T> &m, const std::vector<T> &phi, const std::vector<T> &rho, const std::vector<glm::vec<2, T>> &r, int i, const std::vector<int> &indices, const gkernel<T> &w, T h) {
+    glm::vec<2, T> val = glm::vec<2, T>(0);
     for(int j : indices) {
         if(i == j) continue;
-        glm::vec2 r_ij = r[i] - r[j];
+        glm::vec<2, T> r_ij = r[i] - r[j];
         val += m[j] * phi[j] / rho[j] * w(r_ij, glm::length(r_ij), h);
     }
     return val;
@@ -62,15 +64,86 @@ glm::vec2 InterpolateGradient(const std::vector<float> &m, const std::vector<flo
  * @param[in] h effective_radius
  * @return interpolated laplacian of physical quantity
  */
-glm::vec2 InterpolateLaplacian(const std::vector<float> &m, const std::vector<glm::vec2> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const lkernel &w, float h) {
-    glm::vec2 val = glm::vec2(0.0f, 0.0f);
+template<typename T>
+glm::vec<2, T> InterpolateLaplacian(const std::vector<T> &m, const std::vector<glm::vec<2, T>> &phi, const std::vector<T> &rho, const std::vector<glm::vec<2, T>> &r, int i, const std::vector<int> &indices, const lkernel<T> &w, T h) {
+    glm::vec<2, T> val = glm::vec<2, T>(0);
     for(int j : indices) {
-        glm::vec2 r_ij = r[i] - r[j];
+        glm::vec<2, T> r_ij = r[i] - r[j];
         val += m[j] * (phi[j] - phi[i]) / rho[j] * w(glm::length(r_ij), h);
     }
     return val;
 }
 
+// explicit instantiation
+
+template float Interpolate<float>(const std::vector<float> &m, const std::vector<float> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const kernel<float> &w, float h);
+template glm::vec2 InterpolateGradient<float>(const std::vector<float> &m, const std::vector<float> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const gkernel<float> &w, float h);
+template glm::vec2 InterpolateLaplacian<float>(const std::vector<float> &m, const std::vector<glm::vec2> &phi, const std::vector<float> &rho, const std::vector<glm::vec2> &r, int i, const std::vector<int> &indices, const lkernel<float> &w, float h);
+
+template double Interpolate<double>(const std::vector<double> &m, const std::vector<double> &phi, const std::vector<double> &rho, const std::vector<glm::dvec2> &r, int i, const std::vector<int> &indices, const kernel<double> &w, double h);
+template glm::dvec2 InterpolateGradient<double>(const std::vector<double> &m, const std::vector<double> &phi, const std::vector<double> &rho, const std::vector<glm::dvec2> &r, int i, const std::vector<int> &indices, const gkernel<double> &w, double h);
+template glm::dvec2 InterpolateLaplacian<double>(const std::vector<double> &m, const std::vector<glm::dvec2> &phi, const std::vector<double> &rho, const std::vector<glm::dvec2> &r, int i, const std::vector<int> &indices, const lkernel<double> &w, double h);
+
+/**
+ * @brief convert to IEEE half precision, rounding to nearest even
+ * @param[in] value value
+ * @return bits of half
+ */
+uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t abs = bits & 0x7fffffff;
+    if(abs >= 0x7f800000) return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+    // too large for half becomes infinity
+    if(abs >= 0x477ff000) return sign | 0x7c00;
+    // subnormal half, shift mantissa with implicit bit into place
+    if(abs < 0x38800000) {
+        if(abs < 0x33000000) return sign;
+        int shift = 126 - (abs >> 23);
+        uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midway = 1u << (shift - 1);
+        if(rest > midway || (rest == midway && (half & 1))) half++;
+        return sign | half;
+    }
+    uint32_t half = (abs - 0x38000000) >> 13;
+    uint32_t rest = abs & 0x1fff;
+    if(rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;
+    return sign | half;
+}
+
+/**
+ * @brief convert from IEEE half precision
+ * @param[in] half bits of half
+ * @return value
+ */
+float HalfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+    if(exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else if(exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if(mantissa == 0) {
+        bits = sign;
+    } else {
+        // normalize subnormal
+        exponent = 113;
+        while(!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 /**
  * @brief ground function
  * @param[in] r position
@@ -0,0 +1,323 @@
+/**
+ * @file wall.cpp
+ * @brief Implementation of wall boundary
+ * @author Yuki Ogiwara
+ * @date 2026-10-18
+ */
+
+#include "wall.hpp"
+
+/**
+ * @brief constructor
+ * @param[in] min_coord minimum coordinate of container
+ * @param[in] max_coord maximum coordinate of container
+ */
+template<typename T>
+Wall<T>::Wall(const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord)
+: min_coord_(min_coord), max_coord_(max_coord), open_(false), effective_rad_(0), num_samples_(0) {
+
+}
+
+/**
+ * @brief destructor
+ */
+template<typename T>
+Wall<T>::~Wall() {
+
+}
+
+/**
+ * @brief remove container sides along axes, e.g. periodic ones
+ * @param[in] open open axes
+ */
+template<typename T>
+void Wall<T>::SetOpen(const glm::bvec2 &open) {
+    open_ = open;
+}
+
+/**
+ * @brief add circular obstacle
+ * @param[in] center center
+ * @param[in] radius radius
+ */
+template<typename T>
+void Wall<T>::AddCircle(const glm::vec<2, T> &center, T radius) {
+    circle_centers_.push_back(center);
+    circle_radii_.push_back(radius);
+}
+
+/**
+ * @brief add box obstacle
+ * @param[in] min_coord minimum coordinate
+ * @param[in] max_coord maximum coordinate
+ */
+template<typename T>
+void Wall<T>::AddBox(const glm::vec<2, T> &min_coord, const glm::vec<2, T> &max_coord) {
+    AddPolygon({
+        glm::vec<2, T>(min_coord[0], min_coord[1]),
+        glm::vec<2, T>(max_coord[0], min_coord[1]),
+        glm::vec<2, T>(max_coord[0], max_coord[1]),
+        glm::vec<2, T>(min_coord[0], max_coord[1])
+    });
+}
+
+/**
+ * @brief add polygonal obstacle
+ * @param[in] vertices vertices of simple polygon
+ */
+template<typename T>
+void Wall<T>::AddPolygon(const std::vector<glm::vec<2, T>> &vertices) {
+    polygons_.push_back(vertices);
+}
+
+/**
+ * @brief tabulate contributions of a flat wall made of boundary particle layers
+ * @param[in] w kernel
+ * @param[in] gw gradient of kernel
+ * @param[in] lw laplacian of kernel
+ * @param[in] h effective radius
+ * @param[in] min_h smallest smoothing length of fluid particles
+ * @param[in] max_h largest smoothing length of fluid particles
+ * @param[in] particle_rad particle radius
+ * @param[in] num_layers number of boundary layers
+ * @param[in] mass mass of boundary particle
+ */
+template<typename T>
+void Wall<T>::Precompute(const kernel<T> &w, const gkernel<T> &gw, const lkernel<T> &lw, T h, T min_h, T max_h, T particle_rad, int num_layers, T mass) {
+    const int num_phases = 4;
+    T spacing = 2 * particle_rad;
+    num_samples_ = 64;
+
+    // layers sit at fixed depth, so tables do not scale with h and are kept at lengths a quarter octave apart
+    effective_rad_ = h;
+    radii_.assign(1, min_h);
+    while(radii_.back() < max_h) radii_.push_back(glm::min(radii_.back() * std::pow(T(2), T(0.25)), max_h));
+    dens_table_.assign(radii_.size() * num_samples_, 0);
+    grad_table_.assign(radii_.size() * num_samples_, 0);
+    lap_table_.assign(radii_.size() * num_samples_, 0);
+
+    // density of a particle in the first layer, boundary particles keep effective radius
+    int k_max = (int)std::ceil(h / spacing) + 1;
+    T wall_dens = 0;
+    for(int l = 0; l < num_layers; l++) {
+        for(int k = -k_max; k <= k_max; k++) {
+            glm::vec<2, T> r_ij = glm::vec<2, T>(k * spacing, l * spacing);
+            wall_dens += mass * w(glm::length(r_ij), h);
+        }
+    }
+
+    // particle at distance d from wall, wall particles averaged over tangential offset
+    for(int m = 0; m < radii_.size(); m++) {
+        T h_m = radii_[m];
+        k_max = (int)std::ceil(h_m / spacing) + 1;
+        for(int s = 0; s < num_samples_; s++) {
+            T d = h_m * s / (num_samples_ - 1);
+            int e = m * num_samples_ + s;
+            for(int p = 0; p < num_phases; p++) {
+                T phase = spacing * (p + T(0.5)) / num_phases;
+                for(int l = 0; l < num_layers; l++) {
+                    for(int k = -k_max; k <= k_max; k++) {
+                        glm::vec<2, T> r_ij = glm::vec<2, T>(0, d) - glm::vec<2, T>(k * spacing + phase, -(2*l+1) * particle_rad);
+                        T r = glm::length(r_ij);
+                        dens_table_[e] += mass * w(r, h_m) / num_phases;
+                        grad_table_[e] += mass * gw(r_ij, r, h_m)[1] / num_phases;
+                        lap_table_[e] += mass / wall_dens * lw(r, h_m) / num_phases;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief signed distance to wall (positive on fluid side)
+ * @param[in] pos position
+ * @return distance
+ */
+template<typename T>
+T Wall<T>::Distance(const glm::vec<2, T> &pos) const {
+    glm::vec<2, T> lower = pos - min_coord_;
+    glm::vec<2, T> upper = max_coord_ - pos;
+    for(int a = 0; a < 2; a++) {
+        if(!open_[a]) continue;
+        lower[a] = std::numeric_limits<T>::max();
+        upper[a] = std::numeric_limits<T>::max();
+    }
+    T d = glm::min(glm::min(lower[0], lower[1]), glm::min(upper[0], upper[1]));
+    for(int i = 0; i < circle_centers_.size(); i++) {
+        d = glm::min(d, glm::length(pos - circle_centers_[i]) - circle_radii_[i]);
+    }
+    for(const auto &vertices: polygons_) {
+        d = glm::min(d, PolygonDistance(pos, vertices));
+    }
+    return d;
+}
+
+/**
+ * @brief normal of wall pointing to fluid side
+ * @param[in] pos position
+ * @return normal
+ */
+template<typename T>
+glm::vec<2, T> Wall<T>::Normal(const glm::vec<2, T> &pos) const {
+    T eps = T(1.0e-3) * effective_rad_;
+    glm::vec<2, T> dx = glm::vec<2, T>(eps, 0);
+    glm::vec<2, T> dz = glm::vec<2, T>(0, eps);
+    glm::vec<2, T> grad = glm::vec<2, T>(Distance(pos+dx) - Distance(pos-dx), Distance(pos+dz) - Distance(pos-dz));
+    T len = glm::length(grad);
+    if(len == 0) return glm::vec<2, T>(0);
+    return grad / len;
+}
+
+/**
+ * @brief sum contributions of every wall surface within smoothing length, so that corners see both sides
+ * @param[in] pos position
+ * @param[in] h smoothing length of particle
+ * @param[out] dens interpolated density
+ * @param[out] grad kernel gradient sum along normals of surfaces
+ * @param[out] lap kernel laplacian sum divided by wall density
+ * @return distance to nearest surface
+ */
+template<typename T>
+T Wall<T>::Sum(const glm::vec<2, T> &pos, T h, T *dens, glm::vec<2, T> *grad, T *lap) const {
+    *dens = 0;
+    *grad = glm::vec<2, T>(0);
+    *lap = 0;
+    T nearest = std::numeric_limits<T>::max();
+    auto add = [&](T d, const glm::vec<2, T> &n) {
+        nearest = glm::min(nearest, d);
+        if(d >= h) return;
+        *dens += GetDensity(d, h);
+        *grad += GetGradient(d, h) * n;
+        *lap += GetLaplacian(d, h);
+    };
+
+    // each side of container is a wall of its own
+    for(int a = 0; a < 2; a++) {
+        if(open_[a]) continue;
+        glm::vec<2, T> n = glm::vec<2, T>(0);
+        n[a] = 1;
+        add(pos[a] - min_coord_[a], n);
+        add(max_coord_[a] - pos[a], -n);
+    }
+    for(int i = 0; i < circle_centers_.size(); i++) {
+        glm::vec<2, T> r = pos - circle_centers_[i];
+        T len = glm::length(r);
+        add(len - circle_radii_[i], len > 0 ? r / len : glm::vec<2, T>(0));
+    }
+    T eps = T(1.0e-3) * effective_rad_;
+    glm::vec<2, T> dx = glm::vec<2, T>(eps, 0);
+    glm::vec<2, T> dz = glm::vec<2, T>(0, eps);
+    for(const auto &vertices: polygons_) {
+        T d = PolygonDistance(pos, vertices);
+        if(d >= h) {
+            nearest = glm::min(nearest, d);
+            continue;
+        }
+        glm::vec<2, T> g = glm::vec<2, T>(PolygonDistance(pos+dx, vertices) - PolygonDistance(pos-dx, vertices), PolygonDistance(pos+dz, vertices) - PolygonDistance(pos-dz, vertices));
+        T len = glm::length(g);
+        add(d, len > 0 ? g / len : glm::vec<2, T>(0));
+    }
+    return nearest;
+}
+
+/**
+ * @brief interpolated density contributed by wall
+ * @param[in] d distance to wall
+ * @param[in] h smoothing length
+ * @return density
+ */
+template<typename T>
+T Wall<T>::GetDensity(T d, T h) const {
+    return Lookup(dens_table_, d, h);
+}
+
+/**
+ * @brief kernel gradient sum of wall along normal
+ * @param[in] d distance to wall
+ * @param[in] h smoothing length
+ * @return gradient along normal
+ */
+template<typename T>
+T Wall<T>::GetGradient(T d, T h) const {
+    return Lookup(grad_table_, d, h);
+}
+
+/**
+ * @brief kernel laplacian sum of wall divided by wall density
+ * @param[in] d distance to wall
+ * @param[in] h smoothing length
+ * @return laplacian
+ */
+template<typename T>
+T Wall<T>::GetLaplacian(T d, T h) const {
+    return Lookup(lap_table_, d, h);
+}
+
+/**
+ * @brief signed distance to polygon (positive outside)
+ * @param[in] pos position
+ * @param[in] vertices vertices of polygon
+ * @return distance
+ */
+template<typename T>
+T Wall<T>::PolygonDistance(const glm::vec<2, T> &pos, const std::vector<glm::vec<2, T>> &vertices) const {
+    int n = vertices.size();
+    T d = std::numeric_limits<T>::max();
+    T s = 1;
+    for(int i = 0, j = n-1; i < n; j = i, i++) {
+        glm::vec<2, T> e = vertices[j] - vertices[i];
+        glm::vec<2, T> w = pos - vertices[i];
+        glm::vec<2, T> b = w - e * glm::clamp(glm::dot(w, e) / glm::dot(e, e), T(0), T(1));
+        d = glm::min(d, glm::dot(b, b));
+
+        // crossing number
+        bool c1 = pos[1] >= vertices[i][1];
+        bool c2 = pos[1] < vertices[j][1];
+        bool c3 = e[0] * w[1] > e[1] * w[0];
+        if((c1 && c2 && c3) || (!c1 && !c2 && !c3)) s = -s;
+    }
+    return s * std::sqrt(d);
+}
+
+/**
+ * @brief interpolation of tables between the two tabulated smoothing lengths around h
+ * @param[in] table tables of all smoothing lengths
+ * @param[in] d distance to wall
+ * @param[in] h smoothing length
+ * @return value
+ */
+template<typename T>
+T Wall<T>::Lookup(const std::vector<T> &table, T d, T h) const {
+    int n = radii_.size();
+    int m = glm::clamp((int)(std::upper_bound(radii_.begin(), radii_.end(), h) - radii_.begin()) - 1, 0, n - 1);
+    T value = Sample(table, m, d);
+    if(m + 1 < n && h > radii_[m]) {
+        T t = (h - radii_[m]) / (radii_[m+1] - radii_[m]);
+        value = (1 - t) * value + t * Sample(table, m + 1, d);
+    }
+    return value;
+}
+
+/**
+ * @brief linear interpolation of table sampled on [0, h] of one smoothing length
+ * @param[in] table tables of all smoothing lengths
+ * @param[in] m index of smoothing length
+ * @param[in] d distance to wall
+ * @return value
+ */
+template<typename T>
+T Wall<T>::Sample(const std::vector<T> &table, int m, T d) const {
+    T h = radii_[m];
+    if(d >= h) return 0;
+    T x = glm::max(d, T(0)) / h * (num_samples_ - 1);
+    int i = glm::min((int)x, num_samples_ - 2);
+    T t = x - i;
+    const T *samples = table.data() + m * num_samples_;
+    return (1 - t) * samples[i] + t * samples[i+1];
+}
+
+// explicit instantiation
+
+template class Wall<float>;
+template class Wall<double>;
\ No newline at end of file